@@ -0,0 +1,482 @@
+#include "AST.h"
+#include "Trace.h"
+#include <cctype>
+#include <cstdlib>
+
+static void deleteAll(std::vector<ASTNode*>& nodes) {
+    for (ASTNode* node : nodes) {
+        delete node;
+    }
+    nodes.clear();
+}
+
+ASTCall::~ASTCall() { deleteAll(arguments); }
+ASTIf::~ASTIf() { delete condition; deleteAll(thenBody); deleteAll(elseBody); }
+ASTWhile::~ASTWhile() { delete condition; deleteAll(body); }
+ASTFor::~ASTFor() { deleteAll(init); delete condition; delete step; deleteAll(body); }
+ASTProgram::~ASTProgram() { deleteAll(items); }
+
+ASTFunctionDecl::~ASTFunctionDecl() {
+    for (ASTVarDecl* param : parameters) {
+        delete param;
+    }
+    deleteAll(body);
+}
+
+const char* binaryOperatorToString(BinaryOperator op) {
+    switch (op) {
+        case OP_ADD: return "+";
+        case OP_SUB: return "-";
+        case OP_MUL: return "*";
+        case OP_DIV: return "/";
+        case OP_MOD: return "%";
+        case OP_LT: return "<";
+        case OP_GT: return ">";
+        case OP_LT_EQUAL: return "<=";
+        case OP_GT_EQUAL: return ">=";
+        case OP_EQUAL: return "==";
+        case OP_NOT_EQUAL: return "!=";
+        case OP_AND: return "&&";
+        case OP_OR: return "||";
+    }
+    return "?";
+}
+
+static bool toBinaryOperator(const std::string& text, BinaryOperator& op) {
+    if (text == "+") op = OP_ADD;
+    else if (text == "-") op = OP_SUB;
+    else if (text == "*") op = OP_MUL;
+    else if (text == "/") op = OP_DIV;
+    else if (text == "%") op = OP_MOD;
+    else if (text == "<") op = OP_LT;
+    else if (text == ">") op = OP_GT;
+    else if (text == "<=") op = OP_LT_EQUAL;
+    else if (text == ">=") op = OP_GT_EQUAL;
+    else if (text == "==") op = OP_EQUAL;
+    else if (text == "!=") op = OP_NOT_EQUAL;
+    else if (text == "&&") op = OP_AND;
+    else if (text == "||") op = OP_OR;
+    else return false;
+    return true;
+}
+
+// decodes the escape sequence starting at text[i] (a backslash) and leaves i on its last character
+static char decodeEscape(const std::string& text, size_t& i) {
+    if (i + 1 >= text.size()) return '\\';
+    char c = text[++i];
+    switch (c) {
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        case '0': return '\0';
+        case 'x': {
+            size_t start = i + 1;
+            while (i + 1 < text.size() && std::isxdigit(static_cast<unsigned char>(text[i + 1]))) {
+                i++;
+            }
+            if (i + 1 == start) return 'x';
+            return static_cast<char>(std::strtol(text.substr(start, i + 1 - start).c_str(), nullptr, 16));
+        }
+        default: return c;  // \\, \', \" and anything unknown stand for themselves
+    }
+}
+
+// text between the surrounding quotes with escapes resolved
+static std::string decodeQuoted(const std::string& text) {
+    std::string result;
+    size_t end = text.size() > 1 ? text.size() - 1 : text.size();
+    for (size_t i = 1; i < end; ++i) {
+        if (text[i] == '\\') {
+            result += decodeEscape(text, i);
+        } else {
+            result += text[i];
+        }
+    }
+    return result;
+}
+
+static ASTNode* lowerOperand(const CSTNode* node) {
+    const std::string& text = node->value;
+    if (text.empty()) return nullptr;
+
+    if (text[0] == '"') {
+        return new ASTStringLit(decodeQuoted(text), node->lineNumber);
+    }
+    if (text[0] == '\'') {
+        std::string chars = decodeQuoted(text);
+        return new ASTCharLit(chars.empty() ? '\0' : chars[0], node->lineNumber);
+    }
+    if (std::isdigit(static_cast<unsigned char>(text[0])) ||
+        (text[0] == '-' && text.size() > 1 && std::isdigit(static_cast<unsigned char>(text[1])))) {
+        return new ASTIntLit(std::strtol(text.c_str(), nullptr, 10), node->lineNumber);
+    }
+    return new ASTVarRef(text, node->lineNumber);
+}
+
+static ASTNode* lowerExpression(const CSTNode* node) {
+    if (!node) return nullptr;
+
+    if (node->name == "Operand") {
+        return lowerOperand(node);
+    }
+    if (node->name == "Operator") {
+        const CSTNode* left = node->leftChild;
+        const CSTNode* right = left ? left->rightSibling : nullptr;
+        if (!right) {  // one operand: the parser's '!' and unary '-'
+            ASTNode* operand = lowerExpression(left);
+            if (operand && node->value == "!") return new ASTUnaryOp(OP_NOT, operand, node->lineNumber);
+            if (operand && node->value == "-") return new ASTUnaryOp(OP_NEGATE, operand, node->lineNumber);
+            delete operand;
+            return nullptr;
+        }
+        BinaryOperator op;
+        if (!toBinaryOperator(node->value, op)) return nullptr;
+        ASTNode* leftOperand = lowerExpression(left);
+        ASTNode* rightOperand = lowerExpression(right);
+        if (!leftOperand || !rightOperand) {  // never a binary operator with an operand missing
+            delete leftOperand;
+            delete rightOperand;
+            return nullptr;
+        }
+        return new ASTBinOp(op, leftOperand, rightOperand, node->lineNumber);
+    }
+    if (node->name == "FunctionCall") {
+        ASTCall* call = new ASTCall(node->value, node->lineNumber);
+        for (const CSTNode* arg = node->leftChild; arg; arg = arg->rightSibling) {
+            if (ASTNode* lowered = lowerExpression(arg)) call->arguments.push_back(lowered);
+        }
+        return call;
+    }
+    if (node->name == "ArrayAccess") {
+        return new ASTIndex(node->value, lowerExpression(node->leftChild), node->lineNumber);
+    }
+    if (node->name == "EscapeSequence") {
+        size_t i = 0;
+        return new ASTCharLit(decodeEscape(node->value, i), node->lineNumber);
+    }
+    return nullptr;
+}
+
+static void lowerStatements(const CSTNode* first, std::vector<ASTNode*>& out);
+
+// a single CST statement can lower to several AST statements (e.g. "int a, b;")
+static void lowerStatement(const CSTNode* node, std::vector<ASTNode*>& out) {
+    const std::string& name = node->name;
+
+    if (name == "Symbol") {
+        return;
+    }
+    if (name == "Declaration") {
+        for (const CSTNode* var = node->leftChild; var; var = var->rightSibling) {
+            ASTVarDecl* decl = new ASTVarDecl(var->value, node->value, var->lineNumber);
+            if (var->name == "ArrayDeclaration" && var->leftChild) {
+                decl->isArray = true;
+                decl->arraySize = std::atoi(var->leftChild->value.c_str());
+            }
+            out.push_back(decl);
+        }
+        return;
+    }
+    if (name == "Assignment") {
+        if (node->value == "[]") {  // element assignment: ArrayAccess then the right-hand side
+            const CSTNode* access = node->leftChild;
+            if (!access) return;
+            out.push_back(new ASTAssign(lowerExpression(access), lowerExpression(access->rightSibling), node->lineNumber));
+        } else {
+            out.push_back(new ASTAssign(new ASTVarRef(node->value, node->lineNumber),
+                                        lowerExpression(node->leftChild), node->lineNumber));
+        }
+        return;
+    }
+    if (name == "Increment") {  // i++ / i-- from a for-loop header
+        BinaryOperator op = (node->leftChild && node->leftChild->value == "-") ? OP_SUB : OP_ADD;
+        ASTNode* step = new ASTBinOp(op, new ASTVarRef(node->value, node->lineNumber),
+                                     new ASTIntLit(1, node->lineNumber), node->lineNumber);
+        out.push_back(new ASTAssign(new ASTVarRef(node->value, node->lineNumber), step, node->lineNumber));
+        return;
+    }
+    if (name == "FunctionCall") {
+        out.push_back(lowerExpression(node));
+        return;
+    }
+    if (name == "Return") {
+        out.push_back(new ASTReturn(lowerExpression(node->leftChild), node->lineNumber));
+        return;
+    }
+    if (name == "IfStatement") {
+        const CSTNode* cond = node->leftChild;
+        ASTIf* ifNode = new ASTIf(lowerExpression(cond), node->lineNumber);
+        for (const CSTNode* child = cond ? cond->rightSibling : nullptr; child; child = child->rightSibling) {
+            if (child->name == "ElseStatement") {
+                ifNode->hasElse = true;
+                lowerStatements(child->leftChild, ifNode->elseBody);
+            } else {
+                lowerStatement(child, ifNode->thenBody);
+            }
+        }
+        out.push_back(ifNode);
+        return;
+    }
+    if (name == "WhileStatement") {
+        const CSTNode* cond = node->leftChild;
+        ASTWhile* whileNode = new ASTWhile(lowerExpression(cond), node->lineNumber);
+        if (cond) lowerStatements(cond->rightSibling, whileNode->body);
+        out.push_back(whileNode);
+        return;
+    }
+    if (name == "ForStatement") {  // children: init, condition, step, body...
+        ASTFor* forNode = new ASTFor(node->lineNumber);
+        const CSTNode* init = node->leftChild;
+        const CSTNode* cond = init ? init->rightSibling : nullptr;
+        const CSTNode* step = cond ? cond->rightSibling : nullptr;
+        if (init) lowerStatement(init, forNode->init);
+        forNode->condition = lowerExpression(cond);
+        if (step) {
+            std::vector<ASTNode*> steps;
+            lowerStatement(step, steps);
+            forNode->step = steps.empty() ? nullptr : steps.front();
+            lowerStatements(step->rightSibling, forNode->body);
+        }
+        out.push_back(forNode);
+        return;
+    }
+}
+
+static void lowerStatements(const CSTNode* first, std::vector<ASTNode*>& out) {
+    for (const CSTNode* node = first; node; node = node->rightSibling) {
+        lowerStatement(node, out);
+    }
+}
+
+static ASTFunctionDecl* lowerFunction(const CSTNode* node) {
+    ASTFunctionDecl* function = new ASTFunctionDecl(node->value, node->name == "Function", node->lineNumber);
+
+    for (const CSTNode* child = node->leftChild; child; child = child->rightSibling) {
+        if (child->name == "ReturnType") {
+            function->returnType = child->value;
+        }
+        else if (child->name == "ParameterType") {
+            const CSTNode* param = child->leftChild;  // absent for "(void)"
+            if (!param) continue;
+            ASTVarDecl* decl = new ASTVarDecl(param->value, child->value, param->lineNumber);
+            decl->isParameter = true;
+            if (param->leftChild) {  // ArraySize
+                decl->isArray = true;
+                decl->arraySize = std::atoi(param->leftChild->value.c_str());
+            }
+            function->parameters.push_back(decl);
+        }
+        else {
+            lowerStatement(child, function->body);
+        }
+    }
+    return function;
+}
+
+ASTProgram* lowerCST(const CSTNode* root) {
+    TRACE_SCOPE("lowerCST");
+    ASTProgram* program = new ASTProgram();
+    if (!root) return program;
+
+    for (const CSTNode* node = root->leftChild; node; node = node->rightSibling) {
+        if (node->name == "Function" || node->name == "Procedure") {
+            program->items.push_back(lowerFunction(node));
+        } else {
+            lowerStatement(node, program->items);
+        }
+    }
+    return program;
+}
+
+static size_t countAll(const std::vector<ASTNode*>& nodes) {
+    size_t count = 0;
+    for (const ASTNode* node : nodes) {
+        count += countASTNodes(node);
+    }
+    return count;
+}
+
+size_t countASTNodes(const ASTNode* node) {
+    if (!node) return 0;
+
+    switch (node->kind) {
+        case AST_PROGRAM:
+            return 1 + countAll(static_cast<const ASTProgram*>(node)->items);
+        case AST_FUNCTION_DECL: {
+            const ASTFunctionDecl* function = static_cast<const ASTFunctionDecl*>(node);
+            return 1 + function->parameters.size() + countAll(function->body);
+        }
+        case AST_IF: {
+            const ASTIf* ifNode = static_cast<const ASTIf*>(node);
+            return 1 + countASTNodes(ifNode->condition) + countAll(ifNode->thenBody) + countAll(ifNode->elseBody);
+        }
+        case AST_WHILE: {
+            const ASTWhile* whileNode = static_cast<const ASTWhile*>(node);
+            return 1 + countASTNodes(whileNode->condition) + countAll(whileNode->body);
+        }
+        case AST_FOR: {
+            const ASTFor* forNode = static_cast<const ASTFor*>(node);
+            return 1 + countAll(forNode->init) + countASTNodes(forNode->condition) +
+                   countASTNodes(forNode->step) + countAll(forNode->body);
+        }
+        case AST_RETURN:
+            return 1 + countASTNodes(static_cast<const ASTReturn*>(node)->value);
+        case AST_ASSIGN: {
+            const ASTAssign* assign = static_cast<const ASTAssign*>(node);
+            return 1 + countASTNodes(assign->target) + countASTNodes(assign->value);
+        }
+        case AST_BINOP: {
+            const ASTBinOp* binOp = static_cast<const ASTBinOp*>(node);
+            return 1 + countASTNodes(binOp->left) + countASTNodes(binOp->right);
+        }
+        case AST_UNARYOP:
+            return 1 + countASTNodes(static_cast<const ASTUnaryOp*>(node)->operand);
+        case AST_CALL:
+            return 1 + countAll(static_cast<const ASTCall*>(node)->arguments);
+        case AST_INDEX:
+            return 1 + countASTNodes(static_cast<const ASTIndex*>(node)->index);
+        default:
+            return 1;
+    }
+}
+
+// text in quotes, with the characters that would break the line format escaped
+static std::string quoted(const std::string& text, char quote) {
+    static const char* hex = "0123456789abcdef";
+    std::string result(1, quote);
+    for (char c : text) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '\n') {
+            result += "\\n";
+        } else if (c == '\t') {
+            result += "\\t";
+        } else if (c == '\\' || c == quote) {
+            result += '\\';
+            result += c;
+        } else if (byte < 0x20 || byte == 0x7f) {
+            result += "\\x";
+            result += hex[byte >> 4];
+            result += hex[byte & 15];
+        } else {
+            result += c;
+        }
+    }
+    return result + quote;
+}
+
+static void printASTNode(const ASTNode* node, std::ostream& out, int depth);
+
+static void printAll(const std::vector<ASTNode*>& nodes, std::ostream& out, int depth) {
+    for (const ASTNode* node : nodes) {
+        printASTNode(node, out, depth);
+    }
+}
+
+// like lowerCST this recurses, so it is as deep as the expressions and blocks nest
+static void printASTNode(const ASTNode* node, std::ostream& out, int depth) {
+    if (!node) return;
+    out << std::string(static_cast<size_t>(depth) * 4, ' ');
+
+    switch (node->kind) {
+        case AST_PROGRAM:
+            out << "Program\n";
+            printAll(static_cast<const ASTProgram*>(node)->items, out, depth + 1);
+            return;
+        case AST_FUNCTION_DECL: {
+            const ASTFunctionDecl* function = static_cast<const ASTFunctionDecl*>(node);
+            out << (function->isFunction ? "Function " : "Procedure ") << function->name;
+            if (function->isFunction) out << " -> " << function->returnType;
+            out << " [Line: " << node->lineNumber << "]\n";
+            for (const ASTVarDecl* param : function->parameters) printASTNode(param, out, depth + 1);
+            printAll(function->body, out, depth + 1);
+            return;
+        }
+        case AST_VAR_DECL: {
+            const ASTVarDecl* decl = static_cast<const ASTVarDecl*>(node);
+            out << (decl->isParameter ? "Parameter " : "VarDecl ") << decl->typeName << " " << decl->name;
+            if (decl->isArray) out << "[" << decl->arraySize << "]";
+            out << " [Line: " << node->lineNumber << "]\n";
+            return;
+        }
+        case AST_IF: {
+            const ASTIf* ifNode = static_cast<const ASTIf*>(node);
+            out << "If [Line: " << node->lineNumber << "]\n";
+            printASTNode(ifNode->condition, out, depth + 1);
+            printAll(ifNode->thenBody, out, depth + 1);
+            if (ifNode->hasElse) {
+                out << std::string(static_cast<size_t>(depth) * 4, ' ') << "Else\n";
+                printAll(ifNode->elseBody, out, depth + 1);
+            }
+            return;
+        }
+        case AST_WHILE: {
+            const ASTWhile* whileNode = static_cast<const ASTWhile*>(node);
+            out << "While [Line: " << node->lineNumber << "]\n";
+            printASTNode(whileNode->condition, out, depth + 1);
+            printAll(whileNode->body, out, depth + 1);
+            return;
+        }
+        case AST_FOR: {
+            const ASTFor* forNode = static_cast<const ASTFor*>(node);
+            out << "For [Line: " << node->lineNumber << "]\n";
+            printAll(forNode->init, out, depth + 1);
+            printASTNode(forNode->condition, out, depth + 1);
+            printASTNode(forNode->step, out, depth + 1);
+            printAll(forNode->body, out, depth + 1);
+            return;
+        }
+        case AST_RETURN:
+            out << "Return [Line: " << node->lineNumber << "]\n";
+            printASTNode(static_cast<const ASTReturn*>(node)->value, out, depth + 1);
+            return;
+        case AST_ASSIGN: {
+            const ASTAssign* assign = static_cast<const ASTAssign*>(node);
+            out << "Assign [Line: " << node->lineNumber << "]\n";
+            printASTNode(assign->target, out, depth + 1);
+            printASTNode(assign->value, out, depth + 1);
+            return;
+        }
+        case AST_BINOP: {
+            const ASTBinOp* binOp = static_cast<const ASTBinOp*>(node);
+            out << "BinOp " << binaryOperatorToString(binOp->op) << "\n";
+            printASTNode(binOp->left, out, depth + 1);
+            printASTNode(binOp->right, out, depth + 1);
+            return;
+        }
+        case AST_UNARYOP: {
+            const ASTUnaryOp* unaryOp = static_cast<const ASTUnaryOp*>(node);
+            out << "UnaryOp " << (unaryOp->op == OP_NOT ? "!" : "-") << "\n";
+            printASTNode(unaryOp->operand, out, depth + 1);
+            return;
+        }
+        case AST_CALL: {
+            const ASTCall* call = static_cast<const ASTCall*>(node);
+            out << "Call " << call->name << " [Line: " << node->lineNumber << "]\n";
+            printAll(call->arguments, out, depth + 1);
+            return;
+        }
+        case AST_INDEX: {
+            const ASTIndex* index = static_cast<const ASTIndex*>(node);
+            out << "Index " << index->name << "\n";
+            printASTNode(index->index, out, depth + 1);
+            return;
+        }
+        case AST_INT_LIT:
+            out << "IntLit " << static_cast<const ASTIntLit*>(node)->value << "\n";
+            return;
+        case AST_CHAR_LIT:
+            out << "CharLit " << quoted(std::string(1, static_cast<const ASTCharLit*>(node)->value), '\'') << "\n";
+            return;
+        case AST_STRING_LIT:
+            out << "StringLit " << quoted(static_cast<const ASTStringLit*>(node)->value, '"') << "\n";
+            return;
+        case AST_VAR_REF:
+            out << "VarRef " << static_cast<const ASTVarRef*>(node)->name << "\n";
+            return;
+    }
+}
+
+void printAST(const ASTNode* node, std::ostream& out) {
+    TRACE_SCOPE("printAST");
+    printASTNode(node, out, 0);
+}
@@ -0,0 +1,197 @@
+#ifndef AST_H
+#define AST_H
+
+#include "CSTNode.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// compact typed syntax tree lowered from the CST: punctuation is dropped, literals
+// carry their parsed values and operators are resolved to enums once, so later
+// stages never have to re-discover structure by comparing node names
+enum ASTKind {
+    AST_PROGRAM,
+    AST_FUNCTION_DECL,
+    AST_VAR_DECL,
+    AST_IF,
+    AST_WHILE,
+    AST_FOR,
+    AST_RETURN,
+    AST_ASSIGN,
+    AST_BINOP,
+    AST_UNARYOP,
+    AST_CALL,
+    AST_INDEX,
+    AST_INT_LIT,
+    AST_CHAR_LIT,
+    AST_STRING_LIT,
+    AST_VAR_REF
+};
+
+enum BinaryOperator {
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_MOD,
+    OP_LT,
+    OP_GT,
+    OP_LT_EQUAL,
+    OP_GT_EQUAL,
+    OP_EQUAL,
+    OP_NOT_EQUAL,
+    OP_AND,
+    OP_OR
+};
+
+enum UnaryOperator {
+    OP_NOT,
+    OP_NEGATE
+};
+
+struct ASTNode {
+    ASTKind kind;
+    int lineNumber;
+
+    ASTNode(ASTKind kind, int lineNumber) : kind(kind), lineNumber(lineNumber) {}
+    virtual ~ASTNode() {}
+
+    ASTNode(const ASTNode&) = delete;
+    ASTNode& operator=(const ASTNode&) = delete;
+};
+
+// ---- expressions ----
+
+struct ASTIntLit : ASTNode {
+    long value;
+    ASTIntLit(long value, int lineNumber) : ASTNode(AST_INT_LIT, lineNumber), value(value) {}
+};
+
+struct ASTCharLit : ASTNode {
+    char value;
+    ASTCharLit(char value, int lineNumber) : ASTNode(AST_CHAR_LIT, lineNumber), value(value) {}
+};
+
+struct ASTStringLit : ASTNode {
+    std::string value;  // escape sequences already decoded, no quotes
+    ASTStringLit(const std::string& value, int lineNumber) : ASTNode(AST_STRING_LIT, lineNumber), value(value) {}
+};
+
+struct ASTVarRef : ASTNode {
+    std::string name;
+    ASTVarRef(const std::string& name, int lineNumber) : ASTNode(AST_VAR_REF, lineNumber), name(name) {}
+};
+
+struct ASTIndex : ASTNode {
+    std::string name;
+    ASTNode* index;
+    ASTIndex(const std::string& name, ASTNode* index, int lineNumber)
+        : ASTNode(AST_INDEX, lineNumber), name(name), index(index) {}
+    ~ASTIndex() override { delete index; }
+};
+
+struct ASTCall : ASTNode {
+    std::string name;
+    std::vector<ASTNode*> arguments;
+    ASTCall(const std::string& name, int lineNumber) : ASTNode(AST_CALL, lineNumber), name(name) {}
+    ~ASTCall() override;
+};
+
+struct ASTBinOp : ASTNode {
+    BinaryOperator op;
+    ASTNode* left;
+    ASTNode* right;
+    ASTBinOp(BinaryOperator op, ASTNode* left, ASTNode* right, int lineNumber)
+        : ASTNode(AST_BINOP, lineNumber), op(op), left(left), right(right) {}
+    ~ASTBinOp() override { delete left; delete right; }
+};
+
+struct ASTUnaryOp : ASTNode {
+    UnaryOperator op;
+    ASTNode* operand;
+    ASTUnaryOp(UnaryOperator op, ASTNode* operand, int lineNumber)
+        : ASTNode(AST_UNARYOP, lineNumber), op(op), operand(operand) {}
+    ~ASTUnaryOp() override { delete operand; }
+};
+
+// ---- declarations and statements ----
+
+struct ASTVarDecl : ASTNode {
+    std::string name;
+    std::string typeName;
+    bool isArray;
+    int arraySize;
+    bool isParameter;
+    ASTVarDecl(const std::string& name, const std::string& typeName, int lineNumber)
+        : ASTNode(AST_VAR_DECL, lineNumber), name(name), typeName(typeName),
+          isArray(false), arraySize(0), isParameter(false) {}
+};
+
+struct ASTAssign : ASTNode {
+    ASTNode* target;  // ASTVarRef or ASTIndex
+    ASTNode* value;
+    ASTAssign(ASTNode* target, ASTNode* value, int lineNumber)
+        : ASTNode(AST_ASSIGN, lineNumber), target(target), value(value) {}
+    ~ASTAssign() override { delete target; delete value; }
+};
+
+struct ASTReturn : ASTNode {
+    ASTNode* value;  // nullptr for a bare 'return;'
+    ASTReturn(ASTNode* value, int lineNumber) : ASTNode(AST_RETURN, lineNumber), value(value) {}
+    ~ASTReturn() override { delete value; }
+};
+
+struct ASTIf : ASTNode {
+    ASTNode* condition;
+    std::vector<ASTNode*> thenBody;
+    std::vector<ASTNode*> elseBody;
+    bool hasElse;
+    ASTIf(ASTNode* condition, int lineNumber)
+        : ASTNode(AST_IF, lineNumber), condition(condition), hasElse(false) {}
+    ~ASTIf() override;
+};
+
+struct ASTWhile : ASTNode {
+    ASTNode* condition;
+    std::vector<ASTNode*> body;
+    ASTWhile(ASTNode* condition, int lineNumber) : ASTNode(AST_WHILE, lineNumber), condition(condition) {}
+    ~ASTWhile() override;
+};
+
+struct ASTFor : ASTNode {
+    std::vector<ASTNode*> init;  // a declaration may lower to several statements
+    ASTNode* condition;
+    ASTNode* step;
+    std::vector<ASTNode*> body;
+    ASTFor(int lineNumber) : ASTNode(AST_FOR, lineNumber), condition(nullptr), step(nullptr) {}
+    ~ASTFor() override;
+};
+
+struct ASTFunctionDecl : ASTNode {
+    std::string name;
+    bool isFunction;         // false for procedures
+    std::string returnType;  // empty for procedures
+    std::vector<ASTVarDecl*> parameters;
+    std::vector<ASTNode*> body;
+    ASTFunctionDecl(const std::string& name, bool isFunction, int lineNumber)
+        : ASTNode(AST_FUNCTION_DECL, lineNumber), name(name), isFunction(isFunction) {}
+    ~ASTFunctionDecl() override;
+};
+
+struct ASTProgram : ASTNode {
+    std::vector<ASTNode*> items;  // globals and function declarations in source order
+    ASTProgram() : ASTNode(AST_PROGRAM, -1) {}
+    ~ASTProgram() override;
+};
+
+// lowers a CST produced by Parser::parseProgram; the CST is left untouched
+ASTProgram* lowerCST(const CSTNode* root);
+
+size_t countASTNodes(const ASTNode* node);
+
+// one node per line, children indented under it, in the spirit of the cst_<file> text;
+// used for ast_<file> (--ast)
+void printAST(const ASTNode* node, std::ostream& out);
+const char* binaryOperatorToString(BinaryOperator op);
+
+#endif
@@ -0,0 +1,28 @@
+#include "BinaryStringTable.h"
+#include <cstring>
+
+uint32_t BinaryStringTableBuilder::add(const std::string& text) {
+    auto found = ids.find(text);
+    if (found != ids.end()) return found->second;
+
+    uint32_t id = count();
+    data += text;
+    offsets.push_back(static_cast<uint32_t>(data.size()));
+    ids.emplace(text, id);
+    return id;
+}
+
+void BinaryStringTableBuilder::copyOffsets(char* destination) const {
+    std::memcpy(destination, offsets.data(), offsetsSize());
+}
+
+void BinaryStringTableBuilder::copyData(char* destination) const {
+    if (!data.empty()) std::memcpy(destination, data.data(), data.size());
+}
+
+bool BinaryStringTable::validate(uint32_t byteCount) const {
+    for (uint32_t i = 0; i < count; ++i) {
+        if (offsets[i] > offsets[i + 1]) return false;
+    }
+    return offsets[count] <= byteCount;
+}
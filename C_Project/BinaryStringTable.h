@@ -0,0 +1,40 @@
+#ifndef BINARY_STRING_TABLE_H
+#define BINARY_STRING_TABLE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// string section shared by the binary output formats: count + 1 uint32 offsets, then
+// the bytes. string i spans [offset[i], offset[i + 1]); each distinct string is stored once
+class BinaryStringTableBuilder {
+public:
+    BinaryStringTableBuilder() : offsets(1, 0) {}
+
+    uint32_t add(const std::string& text);
+
+    uint32_t count() const { return static_cast<uint32_t>(offsets.size() - 1); }
+    uint32_t byteCount() const { return static_cast<uint32_t>(data.size()); }
+    size_t offsetsSize() const { return offsets.size() * sizeof(uint32_t); }
+    void copyOffsets(char* destination) const;
+    void copyData(char* destination) const;
+
+private:
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<uint32_t> offsets;
+    std::string data;
+};
+
+// read side, over a mapped file. validate once, then lookups are unchecked
+struct BinaryStringTable {
+    const uint32_t* offsets = nullptr;
+    const char* data = nullptr;
+    uint32_t count = 0;
+
+    bool validate(uint32_t byteCount) const;
+    std::string_view get(uint32_t id) const { return std::string_view(data + offsets[id], offsets[id + 1] - offsets[id]); }
+};
+
+#endif
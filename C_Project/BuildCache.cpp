@@ -0,0 +1,144 @@
+#include "BuildCache.h"
+#include "ByteBuffer.h"
+#include "ContentHash.h"
+#include "MappedFile.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define PROCESS_ID() static_cast<long>(getpid())
+#else
+#include <process.h>
+#define PROCESS_ID() static_cast<long>(_getpid())
+#endif
+
+namespace fs = std::filesystem;
+
+bool BuildCache::open() {
+    if (directory.empty()) return true;
+    std::error_code error;
+    fs::create_directories(directory, error);
+    return fs::is_directory(directory, error);
+}
+
+std::string BuildCache::entryPath(uint64_t key) const {
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+    return directory + "/" + hex;
+}
+
+// everything in RunOptions that changes what is written goes into the key. a parallel parse
+// writes the same as a serial one, so --parallel-parse is left out
+static std::string optionsFingerprint(const RunOptions& options) {
+    std::string text;
+    text += static_cast<char>('0' + options.stopAfter);
+    text += std::to_string(options.emit);
+    text += options.writeBinaryCST ? 'b' : '-';
+    text += options.writeJsonCST ? 'j' : '-';
+    text += options.resolveNames ? 'r' : '-';
+    text += options.writeFrames ? 'f' : '-';
+    text += options.typeCheck ? 't' : '-';
+    text += options.writeBinarySymbols ? 's' : '-';
+    text += options.writeAST ? 'a' : '-';
+    return text;
+}
+
+bool BuildCache::computeKey(const std::string& inputPath, const std::string& name, const RunOptions& options,
+                            uint64_t& key, uint64_t& sourceSize) const {
+    MappedFile source;
+    if (!source.open(inputPath)) return false;
+
+    std::string context = CACHE_TOOL_VERSION;
+    context += '\0';
+    context += optionsFingerprint(options);
+    context += '\0';
+    context += name;
+    key = contentHash(source.data(), source.size(), contentHash(context));
+    sourceSize = source.size();
+    return true;
+}
+
+bool BuildCache::load(uint64_t key, const std::string& name, uint64_t sourceSize, CacheEntry& entry) const {
+    if (directory.empty()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = memory.find(key);
+        if (found == memory.end() || found->second.name != name || found->second.sourceSize != sourceSize) return false;
+        entry = found->second.entry;
+        return true;
+    }
+
+    MappedFile file;
+    if (!file.open(entryPath(key))) return false;
+    ByteReader reader(file.data(), file.size());
+
+    CacheEntryHeader header;
+    if (!reader.getValue(header)) return false;
+    if (std::memcmp(header.magic, "BCHE", 4) != 0 || header.version != CACHE_ENTRY_VERSION ||
+        header.byteOrder != BYTE_ORDER_MARK) {
+        return false;
+    }
+    // a key collision between two different inputs would have to match these as well
+    std::string entryName;
+    if (header.key != key || header.sourceSize != sourceSize || !reader.getString(entryName) || entryName != name) {
+        return false;
+    }
+
+    entry.outputs.resize(header.outputCount);
+    for (CachedOutput& output : entry.outputs) {
+        if (!reader.getString(output.name) || !reader.getBytes(output.bytes)) return false;
+        if (output.name.find_first_of("/\\") != std::string::npos) return false;  // outputs stay in the output directory
+    }
+
+    entry.diagnostics.resize(header.diagnosticCount);
+    for (Diagnostic& diagnostic : entry.diagnostics) {
+        if (!reader.getDiagnostic(diagnostic)) return false;
+    }
+    return reader.atEnd();
+}
+
+bool BuildCache::store(uint64_t key, const std::string& name, uint64_t sourceSize, const CacheEntry& entry) const {
+    if (directory.empty()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        memory[key] = {name, sourceSize, entry};
+        return true;
+    }
+
+    CacheEntryHeader header;
+    std::memset(&header, 0, sizeof(header));  // the padding after byteOrder is written too
+    std::memcpy(header.magic, "BCHE", 4);
+    header.version = CACHE_ENTRY_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.key = key;
+    header.sourceSize = sourceSize;
+    header.outputCount = static_cast<uint32_t>(entry.outputs.size());
+    header.diagnosticCount = static_cast<uint32_t>(entry.diagnostics.size());
+
+    ByteWriter writer;
+    writer.putValue(header);
+    writer.putString(name);
+    for (const CachedOutput& output : entry.outputs) {
+        writer.putString(output.name);
+        writer.putBytes(output.bytes);
+    }
+    for (const Diagnostic& diagnostic : entry.diagnostics) writer.putDiagnostic(diagnostic);
+
+    // the temporary name is unique per process and per call, and rename() replaces the
+    // entry in one step, so a reader sees the old entry, the new one or none
+    static std::atomic<unsigned long> sequence(0);
+    std::string path = entryPath(key);
+    std::string temporary = path + ".tmp" + std::to_string(PROCESS_ID()) + "-" + std::to_string(sequence++);
+    if (!writeWholeFile(temporary, writer.buffer)) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    if (error) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
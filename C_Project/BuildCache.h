@@ -0,0 +1,81 @@
+#ifndef BUILD_CACHE_H
+#define BUILD_CACHE_H
+
+#include "ByteOrder.h"
+#include "CommandLine.h"
+#include "Diagnostic.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// part of every cache key; bump it whenever an output format or an error message changes,
+// so entries written by an older build are never reused
+const char* const CACHE_TOOL_VERSION = "tokenizer-cache-1";
+
+// one output file of a cached input, named as it appears in the output directory
+struct CachedOutput {
+    std::string name;
+    std::vector<char> bytes;
+};
+
+// what the single-file pipeline produced for one input
+struct CacheEntry {
+    std::vector<CachedOutput> outputs;
+    std::vector<Diagnostic> diagnostics;
+};
+
+// on-disk cache of single-file pipeline results (--cache). an entry is keyed by the XXH64 of
+// the input's content, seeded with CACHE_TOOL_VERSION, the options that shape the outputs and
+// the file name (which the outputs contain). entries are written to a private temporary file
+// and renamed into place, so concurrent runs sharing a directory only ever see whole entries.
+// a damaged or mismatched entry is treated as a miss. with an empty directory the entries are
+// kept in memory instead, for as long as the object lives (the compile server's cache); they
+// are never evicted
+class BuildCache {
+public:
+    explicit BuildCache(const std::string& directory) : directory(directory) {}
+
+    bool open();  // creates the directory; false if it cannot be used
+
+    // key of input under options; false if the input cannot be read
+    bool computeKey(const std::string& inputPath, const std::string& name, const RunOptions& options,
+                    uint64_t& key, uint64_t& sourceSize) const;
+
+    bool load(uint64_t key, const std::string& name, uint64_t sourceSize, CacheEntry& entry) const;
+    bool store(uint64_t key, const std::string& name, uint64_t sourceSize, const CacheEntry& entry) const;  // thread-safe
+
+private:
+    std::string entryPath(uint64_t key) const;
+
+    struct MemoryEntry {
+        std::string name;
+        uint64_t sourceSize;
+        CacheEntry entry;
+    };
+
+    std::string directory;
+    mutable std::mutex mutex;  // guards memory
+    mutable std::unordered_map<uint64_t, MemoryEntry> memory;
+};
+
+// cache entry format (<cache>/<key as 16 hex digits>), host byte order:
+//
+//   header       magic "BCHE", version, BYTE_ORDER_MARK, key, source size, output count, diagnostic count
+//   name         length-prefixed input file name
+//   outputs      per output: length-prefixed name, 64-bit size, bytes
+//   diagnostics  per diagnostic: code, severity, arg count, range, length-prefixed args
+const uint32_t CACHE_ENTRY_VERSION = 2;
+
+struct CacheEntryHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t key;
+    uint64_t sourceSize;
+    uint32_t outputCount;
+    uint32_t diagnosticCount;
+};
+
+#endif
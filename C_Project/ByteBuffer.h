@@ -0,0 +1,102 @@
+#ifndef BYTE_BUFFER_H
+#define BYTE_BUFFER_H
+
+#include "Diagnostic.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// append-only writer for the cache entry and compile server formats. values are copied in
+// host byte order; the cache header carries a byte-order mark and the server never leaves
+// the machine
+class ByteWriter {
+public:
+    void put(const void* data, size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+    template <typename T>
+    void putValue(T value) { put(&value, sizeof(value)); }
+    void putString(const std::string& text) {
+        putValue(static_cast<uint32_t>(text.size()));
+        put(text.data(), text.size());
+    }
+    void putBytes(const std::vector<char>& bytes) {
+        putValue(static_cast<uint64_t>(bytes.size()));
+        put(bytes.data(), bytes.size());
+    }
+    void putDiagnostic(const Diagnostic& diagnostic) {
+        putValue(static_cast<uint16_t>(diagnostic.code));
+        putValue(static_cast<uint8_t>(diagnostic.severity));
+        putValue(diagnostic.argCount);
+        putValue(diagnostic.range);
+        for (size_t i = 0; i < diagnostic.argCount; ++i) putString(diagnostic.args[i]);
+    }
+
+    std::vector<char> buffer;
+};
+
+// bounds-checked reader over the same formats; any overrun marks it bad
+class ByteReader {
+public:
+    ByteReader(const void* data, size_t size)
+        : position(static_cast<const unsigned char*>(data)), end(position + size) {}
+
+    bool get(void* out, size_t size) {
+        if (bad || static_cast<size_t>(end - position) < size) {
+            bad = true;
+            return false;
+        }
+        std::memcpy(out, position, size);
+        position += size;
+        return true;
+    }
+    template <typename T>
+    bool getValue(T& value) { return get(&value, sizeof(value)); }
+    bool getString(std::string& text) {
+        uint32_t size = 0;
+        if (!getValue(size) || static_cast<size_t>(end - position) < size) {
+            bad = true;
+            return false;
+        }
+        text.assign(reinterpret_cast<const char*>(position), size);
+        position += size;
+        return true;
+    }
+    bool getBytes(std::vector<char>& bytes) {
+        uint64_t size = 0;
+        if (!getValue(size) || static_cast<uint64_t>(end - position) < size) {
+            bad = true;
+            return false;
+        }
+        bytes.assign(position, position + size);
+        position += size;
+        return true;
+    }
+    bool getDiagnostic(Diagnostic& diagnostic) {
+        uint16_t code = 0;
+        uint8_t severity = 0;
+        if (!getValue(code) || !getValue(severity) || !getValue(diagnostic.argCount) || !getValue(diagnostic.range)) {
+            return false;
+        }
+        if (diagnostic.argCount > DIAGNOSTIC_MAX_ARGS) {
+            bad = true;
+            return false;
+        }
+        diagnostic.code = static_cast<DiagnosticCode>(code);
+        diagnostic.severity = static_cast<Severity>(severity);
+        for (size_t i = 0; i < diagnostic.argCount; ++i) {
+            if (!getString(diagnostic.args[i])) return false;
+        }
+        return true;
+    }
+    bool atEnd() const { return !bad && position == end; }
+
+private:
+    const unsigned char* position;
+    const unsigned char* end;
+    bool bad = false;
+};
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef BYTE_ORDER_H
+#define BYTE_ORDER_H
+
+#include <cstdint>
+
+// the binary outputs are written in host byte order so a reader can use them in place.
+// each header stores this mark right after the version; a machine of the other byte order
+// reads it as 0x04030201 and rejects the file instead of misreading every field
+const uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+#endif
@@ -0,0 +1,143 @@
+#include "CSTBinary.h"
+#include "Trace.h"
+#include <cstring>
+
+CSTBinaryWriter::CSTBinaryWriter() : lastRoot(CST_BINARY_NONE) {}
+
+uint32_t CSTBinaryWriter::addNode(const CSTNode& node) {
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back({strings.add(node.name), strings.add(node.value), node.lineNumber, CST_BINARY_NONE, CST_BINARY_NONE});
+
+    if (open.empty()) {  // a top-level node; chain it after the previous one
+        if (lastRoot != CST_BINARY_NONE) nodes[lastRoot].nextSibling = index;
+        lastRoot = index;
+        return index;
+    }
+
+    OpenNode& parent = open.back();
+    if (parent.lastChild == CST_BINARY_NONE) {
+        nodes[parent.index].firstChild = index;
+    } else {
+        nodes[parent.lastChild].nextSibling = index;
+    }
+    parent.lastChild = index;
+    return index;
+}
+
+void CSTBinaryWriter::enterNode(const CSTNode& node) {
+    uint32_t index = addNode(node);
+    open.push_back({index, CST_BINARY_NONE});
+}
+
+void CSTBinaryWriter::leaf(const CSTNode& node) {
+    addNode(node);
+}
+
+void CSTBinaryWriter::exitNode() {
+    if (!open.empty()) open.pop_back();
+}
+
+bool CSTBinaryWriter::writeTo(const std::string& path) const {
+    TRACE_SCOPE("CSTBinaryWriter::writeTo");
+    CSTBinaryHeader header;
+    std::memcpy(header.magic, "CSTB", 4);
+    header.version = CST_BINARY_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.nodeCount = static_cast<uint32_t>(nodes.size());
+    header.stringCount = strings.count();
+    header.stringBytes = strings.byteCount();
+    header.nodeTableOffset = sizeof(CSTBinaryHeader);
+    header.stringOffsetsOffset = header.nodeTableOffset + header.nodeCount * sizeof(CSTBinaryNode);
+    header.stringDataOffset = header.stringOffsetsOffset + (header.stringCount + 1) * sizeof(uint32_t);
+
+    // assemble the file in memory so it goes out in one write
+    std::vector<char> buffer(header.stringDataOffset + header.stringBytes);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    if (!nodes.empty()) {
+        std::memcpy(buffer.data() + header.nodeTableOffset, nodes.data(), nodes.size() * sizeof(CSTBinaryNode));
+    }
+    strings.copyOffsets(buffer.data() + header.stringOffsetsOffset);
+    strings.copyData(buffer.data() + header.stringDataOffset);
+    return writeWholeFile(path, buffer);
+}
+
+bool CSTBinaryTree::open(const std::string& path) {
+    close();
+    if (!file.open(path)) return false;
+
+    if (file.size() < sizeof(CSTBinaryHeader)) {
+        close();
+        return false;
+    }
+    const unsigned char* base = file.data();
+    header = reinterpret_cast<const CSTBinaryHeader*>(base);
+    nodes = reinterpret_cast<const CSTBinaryNode*>(base + header->nodeTableOffset);
+    strings.offsets = reinterpret_cast<const uint32_t*>(base + header->stringOffsetsOffset);
+    strings.data = reinterpret_cast<const char*>(base + header->stringDataOffset);
+    strings.count = header->stringCount;
+
+    if (!validate()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// checked once at load so the accessors can index without bounds checks
+bool CSTBinaryTree::validate() const {
+    if (std::memcmp(header->magic, "CSTB", 4) != 0 || header->version != CST_BINARY_VERSION ||
+        header->byteOrder != BYTE_ORDER_MARK) {
+        return false;
+    }
+
+    uint64_t nodeEnd = uint64_t(header->nodeTableOffset) + uint64_t(header->nodeCount) * sizeof(CSTBinaryNode);
+    uint64_t offsetsEnd = uint64_t(header->stringOffsetsOffset) + (uint64_t(header->stringCount) + 1) * sizeof(uint32_t);
+    uint64_t dataEnd = uint64_t(header->stringDataOffset) + header->stringBytes;
+    if (header->nodeTableOffset < sizeof(CSTBinaryHeader) || nodeEnd > file.size() ||
+        offsetsEnd > file.size() || dataEnd > file.size() ||
+        header->nodeTableOffset % alignof(CSTBinaryNode) != 0 || header->stringOffsetsOffset % alignof(uint32_t) != 0) {
+        return false;
+    }
+
+    if (!strings.validate(header->stringBytes)) return false;
+
+    for (uint32_t i = 0; i < header->nodeCount; ++i) {
+        const CSTBinaryNode& node = nodes[i];
+        if (node.name >= header->stringCount || node.value >= header->stringCount) return false;
+        // links only point forward (preorder), which also rules out cycles
+        if (node.firstChild != CST_BINARY_NONE && (node.firstChild <= i || node.firstChild >= header->nodeCount)) return false;
+        if (node.nextSibling != CST_BINARY_NONE && (node.nextSibling <= i || node.nextSibling >= header->nodeCount)) return false;
+    }
+    return true;
+}
+
+void CSTBinaryTree::close() {
+    file.close();
+    header = nullptr;
+    nodes = nullptr;
+    strings = BinaryStringTable();
+}
+
+void emitCST(const CSTBinaryTree& tree, CSTListener& listener) {
+    std::vector<uint32_t> pending;  // next sibling to visit at each open level
+    uint32_t current = tree.root();
+
+    while (current != CST_BINARY_NONE || !pending.empty()) {
+        if (current == CST_BINARY_NONE) {
+            current = pending.back();
+            pending.pop_back();
+            listener.exitNode();
+            continue;
+        }
+
+        CSTNode node(std::string(tree.name(current)), std::string(tree.value(current)), tree.lineNumber(current));
+        if (tree.firstChild(current) == CST_BINARY_NONE) {
+            listener.leaf(node);
+            current = tree.nextSibling(current);
+        } else {
+            listener.enterNode(node);
+            pending.push_back(tree.nextSibling(current));
+            current = tree.firstChild(current);
+        }
+    }
+}
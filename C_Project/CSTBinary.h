@@ -0,0 +1,104 @@
+#ifndef CST_BINARY_H
+#define CST_BINARY_H
+
+#include "BinaryStringTable.h"
+#include "ByteOrder.h"
+#include "CSTListener.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// binary CST format (cst_<file>.bin), all fields uint32 in host byte order unless noted:
+//
+//   header      magic "CSTB", version, BYTE_ORDER_MARK, nodeCount, stringCount, stringBytes,
+//               nodeTableOffset, stringOffsetsOffset, stringDataOffset
+//   node table  nodeCount records of {name, value, line (int32), firstChild, nextSibling}
+//               name/value index the string table, children/siblings index the node
+//               table and CST_BINARY_NONE ends a chain. node 0 is the root
+//   strings     stringCount + 1 offsets into the string data, then the data itself.
+//               every distinct name and lexeme is stored once
+//
+// the layout is position independent so a reader can use the file in place
+const uint32_t CST_BINARY_VERSION = 2;
+const uint32_t CST_BINARY_NONE = 0xFFFFFFFFu;
+
+struct CSTBinaryHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t nodeCount;
+    uint32_t stringCount;
+    uint32_t stringBytes;
+    uint32_t nodeTableOffset;
+    uint32_t stringOffsetsOffset;
+    uint32_t stringDataOffset;
+};
+
+struct CSTBinaryNode {
+    uint32_t name;
+    uint32_t value;
+    int32_t line;
+    uint32_t firstChild;
+    uint32_t nextSibling;
+};
+
+// collects the tables as nodes arrive, so it can be attached to a streaming Parser or
+// fed a finished tree through emitCST. nothing touches disk until writeTo
+class CSTBinaryWriter : public CSTListener {
+public:
+    CSTBinaryWriter();
+
+    void enterNode(const CSTNode& node) override;
+    void leaf(const CSTNode& node) override;
+    void exitNode() override;
+
+    // writes the whole file with a single write call
+    bool writeTo(const std::string& path) const;
+
+    size_t getNodeCount() const { return nodes.size(); }
+
+private:
+    struct OpenNode {
+        uint32_t index;
+        uint32_t lastChild;
+    };
+
+    uint32_t addNode(const CSTNode& node);
+
+    std::vector<CSTBinaryNode> nodes;
+    std::vector<OpenNode> open;
+    uint32_t lastRoot;
+    BinaryStringTableBuilder strings;
+};
+
+// read-only view of a cst_<file>.bin. strings point straight into the mapping, so the
+// views stay valid only while the tree is open
+class CSTBinaryTree {
+public:
+    bool open(const std::string& path);  // false if missing, truncated, a different version or byte order
+    void close();
+
+    uint32_t nodeCount() const { return header ? header->nodeCount : 0; }
+    uint32_t root() const { return nodeCount() ? 0 : CST_BINARY_NONE; }
+
+    std::string_view name(uint32_t node) const { return strings.get(nodes[node].name); }
+    std::string_view value(uint32_t node) const { return strings.get(nodes[node].value); }
+    int lineNumber(uint32_t node) const { return nodes[node].line; }
+    uint32_t firstChild(uint32_t node) const { return nodes[node].firstChild; }
+    uint32_t nextSibling(uint32_t node) const { return nodes[node].nextSibling; }
+
+private:
+    bool validate() const;
+
+    MappedFile file;
+    const CSTBinaryHeader* header = nullptr;
+    const CSTBinaryNode* nodes = nullptr;
+    BinaryStringTable strings;
+};
+
+// replays a loaded tree (root and its siblings) into a listener, e.g. a CSTTextWriter
+void emitCST(const CSTBinaryTree& tree, CSTListener& listener);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef CST_LISTENER_H
+#define CST_LISTENER_H
+
+#include "CSTNode.h"
+#include <vector>
+
+// receives the CST in preorder. enterNode/exitNode bracket a node's children, nodes
+// without children arrive through leaf. a Parser with a listener streams each node as
+// soon as it is complete instead of keeping the whole tree (see Parser::setListener)
+class CSTListener {
+public:
+    virtual ~CSTListener() {}
+    virtual void enterNode(const CSTNode& node) = 0;
+    virtual void leaf(const CSTNode& node) = 0;
+    virtual void exitNode() = 0;
+};
+
+// forwards every callback to each added listener, e.g. the text, binary and JSON writers
+class CSTListenerGroup : public CSTListener {
+public:
+    void add(CSTListener* listener) { listeners.push_back(listener); }
+    bool empty() const { return listeners.empty(); }
+
+    void enterNode(const CSTNode& node) override { for (CSTListener* l : listeners) l->enterNode(node); }
+    void leaf(const CSTNode& node) override { for (CSTListener* l : listeners) l->leaf(node); }
+    void exitNode() override { for (CSTListener* l : listeners) l->exitNode(); }
+
+private:
+    std::vector<CSTListener*> listeners;
+};
+
+// replays a finished subtree (node and its children, not its right siblings). iterative,
+// so neither nesting nor long sibling chains grow the call stack
+void emitCST(const CSTNode* node, CSTListener& listener);
+
+#endif
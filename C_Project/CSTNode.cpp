@@ -25,3 +25,31 @@ void CSTNode::addSibling(CSTNode* sibling) {
         lastSibling->rightSibling = sibling;
     }
 }
+
+size_t countNodes(const CSTNode* root) {
+    std::vector<const CSTNode*> pending;
+    if (root) pending.push_back(root);
+
+    size_t count = 0;
+    while (!pending.empty()) {
+        const CSTNode* node = pending.back();
+        pending.pop_back();
+        count++;
+        if (node->leftChild) pending.push_back(node->leftChild);
+        if (node->rightSibling) pending.push_back(node->rightSibling);
+    }
+    return count;
+}
+
+void deleteTree(CSTNode* root) {
+    std::vector<CSTNode*> pending;
+    if (root) pending.push_back(root);
+
+    while (!pending.empty()) {
+        CSTNode* node = pending.back();
+        pending.pop_back();
+        if (node->leftChild) pending.push_back(node->leftChild);
+        if (node->rightSibling) pending.push_back(node->rightSibling);
+        delete node;
+    }
+}
@@ -5,19 +5,35 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include "DataType.h"
 
 struct CSTNode {
     std::string name;
     std::string value;
     int lineNumber;
+    bool streamed;  // already handed to a CSTListener (streaming parse)
+    // filled in by NameResolver for identifier uses, -1 until then (see NameResolver.h)
+    int symbolId;
+    int scopeDepth;
+    int slotIndex;
+    // expression type cached by TypeChecker, TYPE_UNKNOWN until then
+    DataType type;
+    bool typeIsArray;
     CSTNode* leftChild;
     CSTNode* rightSibling;
 
     CSTNode(const std::string& name, const std::string& value = "", int lineNumber = -1)
-        : name(name), value(value), lineNumber(lineNumber), leftChild(nullptr), rightSibling(nullptr) {}
+        : name(name), value(value), lineNumber(lineNumber), streamed(false),
+          symbolId(-1), scopeDepth(-1), slotIndex(-1),
+          type(TYPE_UNKNOWN), typeIsArray(false), leftChild(nullptr), rightSibling(nullptr) {}
 
     void addChild(CSTNode* child);
     void addSibling(CSTNode* sibling);
 };
 
+// frees a node, its children and its right siblings without recursing
+void deleteTree(CSTNode* root);
+// the number of nodes in root, its children and its right siblings, also without recursing
+size_t countNodes(const CSTNode* root);
+
 #endif
@@ -0,0 +1,136 @@
+#include "CSTWriter.h"
+
+void emitCST(const CSTNode* node, CSTListener& listener) {
+    if (!node) return;
+
+    // one entry per open node: the child to visit next at that level
+    std::vector<const CSTNode*> pending;
+    const CSTNode* current = node;
+
+    while (true) {
+        if (current->leftChild) {
+            listener.enterNode(*current);
+            pending.push_back(current->leftChild);
+        } else {
+            listener.leaf(*current);
+        }
+
+        // climb until some open node still has a child left
+        while (!pending.empty() && !pending.back()) {
+            pending.pop_back();
+            listener.exitNode();
+        }
+        if (pending.empty()) return;
+
+        current = pending.back();
+        pending.back() = current->rightSibling;
+    }
+}
+
+// indentation comes from one shared run of spaces instead of a per-space loop
+static void writePadding(std::ostream& out, size_t width) {
+    static const std::string spaces(256, ' ');
+    while (width > spaces.size()) {
+        out.write(spaces.data(), spaces.size());
+        width -= spaces.size();
+    }
+    out.write(spaces.data(), width);
+}
+
+void CSTTextWriter::writeLine(const CSTNode& node) {
+    writePadding(out, static_cast<size_t>(depth) * 4);
+
+    if (node.name == "Symbol") {
+        out << '"' << node.value << "\"\n";
+    } else {
+        out << node.name << " (" << node.value << ") [Line: " << node.lineNumber << "]\n";
+    }
+}
+
+void CSTTextWriter::enterNode(const CSTNode& node) {
+    writeLine(node);
+    depth++;
+}
+
+void CSTTextWriter::leaf(const CSTNode& node) {
+    writeLine(node);
+}
+
+void CSTTextWriter::exitNode() {
+    depth--;
+}
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    static const char hex[] = "0123456789abcdef";
+    out << '"';
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            case '\r': out << "\\r"; break;
+            default:
+                if (c < 0x20) {
+                    out << "\\u00" << hex[c >> 4] << hex[c & 0xF];
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+CSTJsonWriter::CSTJsonWriter(std::ostream& out) : out(out) {
+    out << "[";
+    hasElements.push_back(false);
+}
+
+void CSTJsonWriter::beginObject(const CSTNode& node) {
+    if (hasElements.back()) out << ",";
+    hasElements.back() = true;
+    out << "\n";
+    writePadding(out, hasElements.size() * 2);
+
+    out << "{\"name\": ";
+    writeJsonString(out, node.name);
+    out << ", \"value\": ";
+    writeJsonString(out, node.value);
+    out << ", \"line\": " << node.lineNumber;
+    if (node.symbolId >= 0) {  // resolved identifier use (NameResolver)
+        out << ", \"symbol\": " << node.symbolId << ", \"slot\": [" << node.scopeDepth << ", " << node.slotIndex << "]";
+    }
+}
+
+void CSTJsonWriter::enterNode(const CSTNode& node) {
+    beginObject(node);
+    out << ", \"children\": [";
+    hasElements.push_back(false);
+}
+
+void CSTJsonWriter::leaf(const CSTNode& node) {
+    beginObject(node);
+    out << ", \"children\": []}";
+}
+
+void CSTJsonWriter::exitNode() {
+    hasElements.pop_back();
+    out << "\n";
+    writePadding(out, hasElements.size() * 2);
+    out << "]}";
+}
+
+void CSTJsonWriter::finish() {
+    out << "\n]\n";
+}
+
+void writeCST(const CSTNode* node, std::ostream& out, CSTOutputFormat format) {
+    if (format == CST_FORMAT_JSON) {
+        CSTJsonWriter writer(out);
+        for (; node; node = node->rightSibling) emitCST(node, writer);
+        writer.finish();
+    } else {
+        CSTTextWriter writer(out);
+        for (; node; node = node->rightSibling) emitCST(node, writer);
+    }
+}
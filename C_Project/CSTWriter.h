@@ -0,0 +1,54 @@
+#ifndef CST_WRITER_H
+#define CST_WRITER_H
+
+#include "CSTListener.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// writes the indented text format of the cst_<file> outputs as nodes arrive
+class CSTTextWriter : public CSTListener {
+public:
+    explicit CSTTextWriter(std::ostream& out) : out(out), depth(0) {}
+
+    void enterNode(const CSTNode& node) override;
+    void leaf(const CSTNode& node) override;
+    void exitNode() override;
+
+private:
+    void writeLine(const CSTNode& node);
+
+    std::ostream& out;
+    int depth;
+};
+
+// writes the CST as a JSON array of {"name", "value", "line", "children"} objects.
+// the opening bracket goes out on construction, finish() closes the array
+class CSTJsonWriter : public CSTListener {
+public:
+    explicit CSTJsonWriter(std::ostream& out);
+
+    void enterNode(const CSTNode& node) override;
+    void leaf(const CSTNode& node) override;
+    void exitNode() override;
+    void finish();
+
+private:
+    void beginObject(const CSTNode& node);
+
+    std::ostream& out;
+    std::vector<bool> hasElements;  // per open array: whether a comma is needed before the next element
+};
+
+enum CSTOutputFormat {
+    CST_FORMAT_TEXT,
+    CST_FORMAT_JSON
+};
+
+// text as a quoted JSON string with the required escapes; also used by the diagnostics output
+void writeJsonString(std::ostream& out, const std::string& text);
+
+// writes node and its right siblings, with their subtrees, in the given format
+void writeCST(const CSTNode* node, std::ostream& out, CSTOutputFormat format);
+
+#endif
@@ -0,0 +1,243 @@
+#include "CommandLine.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+// the value of "--name=value", or nullptr if argument is not that option
+static const char* optionValue(const char* argument, const char* name) {
+    size_t length = std::strlen(name);
+    if (std::strncmp(argument, name, length) != 0 || argument[length] != '=') return nullptr;
+    return argument + length + 1;
+}
+
+static bool parseStage(const std::string& text, Stage& stage) {
+    if (text == "strip") stage = STAGE_STRIP;
+    else if (text == "lex") stage = STAGE_LEX;
+    else if (text == "parse") stage = STAGE_PARSE;
+    else if (text == "symbols") stage = STAGE_SYMBOLS;
+    else return false;
+    return true;
+}
+
+// comma-separated list of stripped, tokens, cst, symbols (or "all")
+static bool parseEmit(const std::string& text, unsigned& emit) {
+    emit = 0;
+    size_t begin = 0;
+    while (begin <= text.size()) {
+        size_t end = text.find(',', begin);
+        if (end == std::string::npos) end = text.size();
+        std::string item = text.substr(begin, end - begin);
+        if (item == "stripped") emit |= EMIT_STRIPPED;
+        else if (item == "tokens") emit |= EMIT_TOKENS;
+        else if (item == "cst") emit |= EMIT_CST;
+        else if (item == "symbols") emit |= EMIT_SYMBOLS;
+        else if (item == "all") emit |= EMIT_ALL;
+        else return false;
+        begin = end + 1;
+    }
+    return true;
+}
+
+bool parseCommandLine(int argc, char* argv[], CommandLine& commandLine, std::string& error) {
+    RunOptions& options = commandLine.options;
+    for (int i = 1; i < argc; ++i) {
+        const char* argument = argv[i];
+        const char* value = nullptr;
+
+        if (std::strcmp(argument, "--help") == 0 || std::strcmp(argument, "-h") == 0) {
+            commandLine.showHelp = true;
+        } else if (std::strcmp(argument, "-o") == 0) {
+            if (i + 1 == argc) {
+                error = "-o needs a directory";
+                return false;
+            }
+            commandLine.outputDirectory = argv[++i];
+        } else if ((value = optionValue(argument, "--output"))) {
+            commandLine.outputDirectory = value;
+        } else if ((value = optionValue(argument, "--stop-after"))) {
+            if (!parseStage(value, options.stopAfter)) {
+                error = std::string("unknown stage for --stop-after: ") + value;
+                return false;
+            }
+        } else if ((value = optionValue(argument, "--emit"))) {
+            if (!parseEmit(value, options.emit)) {
+                error = std::string("unknown output in --emit: ") + value;
+                return false;
+            }
+        } else if ((value = optionValue(argument, "--jobs"))) {
+            if (std::atoi(value) <= 0) {
+                error = std::string("--jobs needs a positive number: ") + value;
+                return false;
+            }
+            commandLine.threadCount = static_cast<unsigned int>(std::atoi(value));
+        } else if (std::strcmp(argument, "--parallel-parse") == 0) {
+            options.parallelParse = true;
+        } else if ((value = optionValue(argument, "--parallel-parse"))) {
+            if (std::atoi(value) <= 0) {
+                error = std::string("--parallel-parse needs a positive number: ") + value;
+                return false;
+            }
+            options.parallelParse = true;
+            options.parseThreadCount = static_cast<unsigned int>(std::atoi(value));
+        } else if (std::strcmp(argument, "--serve") == 0) {
+            commandLine.serve = true;
+        } else if ((value = optionValue(argument, "--serve"))) {
+            commandLine.serve = true;
+            commandLine.socketPath = value;
+        } else if (std::strcmp(argument, "--watch") == 0) {
+            commandLine.watch = true;
+        } else if (std::strcmp(argument, "--cache") == 0) {
+            commandLine.cacheDirectory = ".tokenizer-cache";
+        } else if ((value = optionValue(argument, "--cache"))) {
+            commandLine.cacheDirectory = value;
+        } else if (std::strcmp(argument, "--time-report") == 0) {
+            commandLine.timeReport = true;
+        } else if ((value = optionValue(argument, "--time-report"))) {
+            commandLine.timeReport = true;
+            commandLine.timeReportFile = value;
+        } else if (std::strcmp(argument, "--cst-bin") == 0) {
+            options.writeBinaryCST = true;
+        } else if (std::strcmp(argument, "--cst-json") == 0) {
+            options.writeJsonCST = true;
+        } else if (std::strcmp(argument, "--ast") == 0) {
+            options.writeAST = true;
+        } else if (std::strcmp(argument, "--resolve") == 0) {
+            options.resolveNames = true;
+        } else if (std::strcmp(argument, "--frames") == 0) {
+            options.writeFrames = true;
+        } else if (std::strcmp(argument, "--typecheck") == 0) {
+            options.typeCheck = true;
+            options.resolveNames = true;
+        } else if (std::strcmp(argument, "--multi-file") == 0) {
+            commandLine.multiFile = true;
+        } else if (std::strcmp(argument, "--symbols-bin") == 0) {
+            options.writeBinarySymbols = true;
+        } else if (std::strcmp(argument, "--diagnostics-json") == 0) {
+            commandLine.writeJsonDiagnostics = true;
+        } else if (std::strcmp(argument, "--diagnostics-bin") == 0) {
+            commandLine.writeBinaryDiagnostics = true;
+        } else if (argument[0] == '-' && argument[1] != '\0') {
+            error = std::string("Unknown option: ") + argument;
+            return false;
+        } else {
+            commandLine.inputs.push_back(argument);
+        }
+    }
+
+    if (commandLine.multiFile && options.stopAfter != STAGE_SYMBOLS) {
+        error = "--multi-file needs the whole pipeline (--stop-after=symbols)";
+        return false;
+    }
+    if (commandLine.multiFile && !commandLine.cacheDirectory.empty()) {
+        error = "--cache works per file and cannot be used with --multi-file";
+        return false;
+    }
+    if (commandLine.watch && (commandLine.multiFile || !commandLine.cacheDirectory.empty())) {
+        error = "--watch keeps its own in-memory state and cannot be used with --multi-file or --cache";
+        return false;
+    }
+    if (options.parallelParse && (commandLine.multiFile || commandLine.watch)) {
+        error = "--parallel-parse cannot be used with --multi-file (files are already parsed in parallel) or --watch "
+                "(which reparses only the definitions that changed)";
+        return false;
+    }
+    if (commandLine.timeReport && (commandLine.multiFile || commandLine.watch || !commandLine.cacheDirectory.empty())) {
+        error = "--time-report times single runs of every file and cannot be used with --multi-file, --watch or --cache";
+        return false;
+    }
+    if (commandLine.serve && (commandLine.watch || !commandLine.inputs.empty())) {
+        error = "--serve takes no inputs: every request brings its own";
+        return false;
+    }
+    if (commandLine.inputs.empty()) commandLine.inputs.push_back("testfiles/TestFiles4");
+    return true;
+}
+
+void printUsage(const char* program, std::ostream& out) {
+    out << "usage: " << program << " [options] [file | directory | glob]...\n"
+        << "\n"
+        << "inputs default to testfiles/TestFiles4. a directory stands for the files in it, and\n"
+        << "'*' / '?' in the file name part of a path are wildcards (quote them from the shell).\n"
+        << "\n"
+        << "  -o <dir>, --output=<dir>   where outputs go (default outputfiles)\n"
+        << "  --stop-after=<stage>       strip, lex, parse or symbols (default: symbols, the whole pipeline)\n"
+        << "  --emit=<list>              which of stripped,tokens,cst,symbols to write (default all)\n"
+        << "  --jobs=<n>                 process up to n files at once (default one per core)\n"
+        << "  --parallel-parse[=<n>]     parse the procedures/functions of each file on n threads (default: cores / jobs)\n"
+        << "  --serve[=<socket>]         stay resident and run requests from tokenizer-client (Unix domain socket)\n"
+        << "  --watch                    keep running and process files again as they are saved (Linux)\n"
+        << "  --cache[=<dir>]            reuse the outputs of unchanged files, kept in <dir> (default .tokenizer-cache)\n"
+        << "  --time-report[=<file>]     print per-phase times and throughput, JSON in <file> (default <output>/time_report.json)\n"
+        << "  --cst-bin                  also write cst_<file>.bin, the mmap-loadable CST\n"
+        << "  --cst-json                 also write cst_<file>.json\n"
+        << "  --symbols-bin              also write symboltable_<file>.bin, the mmap-loadable symbol table\n"
+        << "  --ast                      also write ast_<file>, the typed AST lowered from the CST, with node counts\n"
+        << "  --resolve                  bind identifier uses to declarations, report undeclared names\n"
+        << "  --typecheck                type-check expressions, assignments and calls (implies --resolve)\n"
+        << "  --frames                   write frames_<file>, the stack frame layout of every procedure/function\n"
+        << "  --multi-file               treat all inputs as one program with a shared global scope\n"
+        << "  --diagnostics-json         write every logged error to <output>/diagnostics.json\n"
+        << "  --diagnostics-bin          write every logged error to <output>/diagnostics.bin\n";
+}
+
+// '*' matches any run of characters, '?' any one character
+static bool wildcardMatch(const char* pattern, const char* text) {
+    const char* star = nullptr;
+    const char* resume = nullptr;
+    while (*text) {
+        if (*pattern == '?' || *pattern == *text) {
+            pattern++;
+            text++;
+        } else if (*pattern == '*') {
+            star = pattern++;
+            resume = text;
+        } else if (star) {
+            pattern = star + 1;
+            text = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (*pattern == '*') pattern++;
+    return *pattern == '\0';
+}
+
+bool expandInputs(const std::vector<std::string>& arguments, std::vector<fs::path>& files, std::string& error) {
+    for (const std::string& argument : arguments) {
+        fs::path path(argument);
+        std::string name = path.filename().string();
+        size_t before = files.size();
+
+        if (name.find_first_of("*?") != std::string::npos) {
+            fs::path directory = path.has_parent_path() ? path.parent_path() : fs::path(".");
+            std::error_code status;
+            if (fs::is_directory(directory, status)) {
+                for (const auto& entry : fs::directory_iterator(directory)) {
+                    if (entry.is_regular_file() && wildcardMatch(name.c_str(), entry.path().filename().string().c_str())) {
+                        files.push_back(entry.path());
+                    }
+                }
+            }
+        } else if (fs::is_directory(path)) {
+            for (const auto& entry : fs::directory_iterator(path)) {
+                if (entry.is_regular_file()) files.push_back(entry.path());
+            }
+            continue;  // an empty directory is not an error
+        } else if (fs::is_regular_file(path)) {
+            files.push_back(path);
+        }
+
+        if (files.size() == before) {
+            error = "no input files match: " + argument;
+            return false;
+        }
+    }
+
+    // sorted, so reports come out in the same order on every machine. in multi-file mode the
+    // order also decides which of two duplicate definitions is reported
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef COMMAND_LINE_H
+#define COMMAND_LINE_H
+
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// the pipeline stages, in order; --stop-after runs up to and including one of them
+enum Stage {
+    STAGE_STRIP,    // comment removal
+    STAGE_LEX,      // + tokenizer
+    STAGE_PARSE,    // + parser (CST)
+    STAGE_SYMBOLS   // + symbol table, and --resolve/--typecheck/--frames if asked for
+};
+
+// which per-file outputs are written (--emit)
+enum EmitFlags : unsigned {
+    EMIT_STRIPPED = 1,  // <file>, the source without comments
+    EMIT_TOKENS = 2,    // tokens_<file>
+    EMIT_CST = 4,       // cst_<file> (and its --cst-bin / --cst-json forms)
+    EMIT_SYMBOLS = 8,   // symboltable_<file> (and its --symbols-bin form)
+    EMIT_ALL = EMIT_STRIPPED | EMIT_TOKENS | EMIT_CST | EMIT_SYMBOLS
+};
+
+// what the single-file pipeline runs and writes
+struct RunOptions {
+    Stage stopAfter = STAGE_SYMBOLS;
+    unsigned emit = EMIT_ALL;
+    bool writeBinaryCST = false;
+    bool writeJsonCST = false;
+    bool resolveNames = false;
+    bool writeFrames = false;
+    bool typeCheck = false;
+    bool writeBinarySymbols = false;
+    bool writeAST = false;
+    // how the parse runs, not what it produces
+    bool parallelParse = false;
+    unsigned int parseThreadCount = 0;  // per file; 0 = the cores left over by the file workers
+};
+
+struct CommandLine {
+    std::vector<std::string> inputs;  // files, directories or globs, as given
+    std::string outputDirectory = "outputfiles";
+    RunOptions options;
+    bool multiFile = false;
+    bool writeJsonDiagnostics = false;
+    bool writeBinaryDiagnostics = false;
+    unsigned int threadCount = 0;  // 0 = one per core
+    std::string cacheDirectory;    // empty = no build cache
+    bool watch = false;
+    bool serve = false;
+    std::string socketPath;        // --serve=<path>; empty = defaultSocketPath()
+    bool timeReport = false;
+    std::string timeReportFile;    // --time-report=<file>; empty = <output>/time_report.json
+    bool showHelp = false;
+};
+
+// false (with a message in error) on an unknown option or a bad value
+bool parseCommandLine(int argc, char* argv[], CommandLine& commandLine, std::string& error);
+void printUsage(const char* program, std::ostream& out);
+
+// turns the input arguments into the sorted list of files to process. a directory stands for
+// the regular files directly in it; '*' and '?' in the last path component match file names.
+// false (with a message in error) if an argument names nothing
+bool expandInputs(const std::vector<std::string>& arguments, std::vector<std::filesystem::path>& files,
+                  std::string& error);
+
+#endif
@@ -1,10 +1,9 @@
 #include "CommentRemover.h"
+#include "Trace.h"
 #include "ErrorHandler.h"
 #include <iostream>
 #include <fstream>
 
-extern ErrorHandler errorHandler;
-
 enum State {
     NORMAL,               // Default state (reading code normally)
     SINGLE_LINE_COMMENT,  // Inside `// ...`
@@ -15,16 +14,24 @@ enum State {
 void CommentRemover::removeComments(const std::string& inputFilename, const std::string& outputFilename) {
     std::ifstream inputFile(inputFilename);
     if (!inputFile) {
-        errorHandler.addError(0, "Error: Unable to open input file " + inputFilename);
+        errorHandler.report(DIAG_CANNOT_OPEN_INPUT, 0, inputFilename);
         return;
     }
 
     std::ofstream outputFile(outputFilename);
     if (!outputFile) {
-        errorHandler.addError(0, "Error: Unable to create output file " + outputFilename);
+        errorHandler.report(DIAG_CANNOT_CREATE_OUTPUT, 0, outputFilename);
         return;
     }
 
+    if (!removeComments(inputFile, outputFile)) {
+        outputFile.close();
+        std::remove(outputFilename.c_str());  // no half-stripped file is left behind
+    }
+}
+
+bool CommentRemover::removeComments(std::istream& inputFile, std::ostream& outputFile) {
+    TRACE_SCOPE("CommentRemover::removeComments");
     char current, next;
     State currentState = NORMAL;
     int lineNumber = 1;
@@ -61,11 +68,8 @@ void CommentRemover::removeComments(const std::string& inputFilename, const std:
                 else if (current == '*') {
                     if (inputFile.get(next) && next == '/') {
                         // Error: Closing comment */ found without opening /*
-                        errorHandler.addError(lineNumber, "Lexical Error: Unmatched closing comment '*/'.");
-                        inputFile.close();
-                        outputFile.close();
-                        std::remove(outputFilename.c_str());
-                        return;
+                        errorHandler.report(DIAG_UNMATCHED_COMMENT_CLOSE, lineNumber);
+                        return false;
                     } else {
                         outputFile.put(current);
                         inputFile.putback(next);
@@ -113,19 +117,15 @@ void CommentRemover::removeComments(const std::string& inputFilename, const std:
         }
     }
 
-    inputFile.close();
-    outputFile.close();
-
     if (currentState == MULTI_LINE_COMMENT) {
-        errorHandler.addError(commentStartLine, "Lexical Error: Unterminated block comment.");
-        std::remove(outputFilename.c_str());  
-        return;
+        errorHandler.report(DIAG_UNTERMINATED_COMMENT, commentStartLine);
+        return false;
     }
 
     if (!containsNonCommentCode) {
-        errorHandler.addError(1, "Lexical Error: Entire file was enclosed in a comment.");
-        std::remove(outputFilename.c_str());  
-        return;
+        errorHandler.report(DIAG_FILE_IS_COMMENT, 1);
+        return false;
     }
 
+    return true;
 }
@@ -1,12 +1,21 @@
 #ifndef COMMENT_REMOVER_H
 #define COMMENT_REMOVER_H
 
+#include <istream>
+#include <ostream>
 #include <string>
 #include "ErrorHandler.h"  // Include ErrorHandler
 
 class CommentRemover {
 public:
+    explicit CommentRemover(ErrorHandler& errorHandler) : errorHandler(errorHandler) {}
     void removeComments(const std::string& inputFilename, const std::string& outputFilename);
+    // the same on streams, e.g. to keep the stripped source in memory. false if the
+    // result is unusable (the errors are reported); output may then hold a partial copy
+    bool removeComments(std::istream& inputFile, std::ostream& outputFile);
+
+private:
+    ErrorHandler& errorHandler;  // the unit's diagnostics, owned by the caller
 };
 
 #endif // COMMENT_REMOVER_H
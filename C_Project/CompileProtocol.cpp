@@ -0,0 +1,253 @@
+#include "CompileProtocol.h"
+#include "ByteBuffer.h"
+#include <cstring>
+#include <filesystem>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_UNIX_SOCKETS 1
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace fs = std::filesystem;
+
+static const uint64_t MAX_PAYLOAD_BYTES = 1ull << 30;
+
+struct FrameHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t payloadSize;
+};
+
+std::string defaultSocketPath() {
+    std::error_code error;
+    fs::path directory = fs::temp_directory_path(error);
+    if (error) directory = "/tmp";
+#ifdef HAVE_UNIX_SOCKETS
+    return (directory / ("tokenizer-" + std::to_string(getuid()) + ".sock")).string();
+#else
+    return (directory / "tokenizer.sock").string();
+#endif
+}
+
+static bool writeAll(int connection, const void* data, size_t size) {
+#ifdef HAVE_UNIX_SOCKETS
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        // MSG_NOSIGNAL: a client that went away is an error here, not a SIGPIPE for the server
+        ssize_t written = ::send(connection, bytes, size, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+#else
+    (void)connection;
+    (void)data;
+    (void)size;
+    return false;
+#endif
+}
+
+static bool readAll(int connection, void* data, size_t size) {
+#ifdef HAVE_UNIX_SOCKETS
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t count = ::recv(connection, bytes, size, 0);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) return false;
+        bytes += count;
+        size -= static_cast<size_t>(count);
+    }
+    return true;
+#else
+    (void)connection;
+    (void)data;
+    (void)size;
+    return false;
+#endif
+}
+
+static bool sendFrame(int connection, const std::vector<char>& payload) {
+    FrameHeader header;
+    std::memcpy(header.magic, "TKSV", 4);
+    header.version = COMPILE_PROTOCOL_VERSION;
+    header.payloadSize = payload.size();
+    return writeAll(connection, &header, sizeof(header)) && writeAll(connection, payload.data(), payload.size());
+}
+
+static bool receiveFrame(int connection, std::vector<char>& payload) {
+    FrameHeader header;
+    if (!readAll(connection, &header, sizeof(header))) return false;
+    if (std::memcmp(header.magic, "TKSV", 4) != 0 || header.version != COMPILE_PROTOCOL_VERSION ||
+        header.payloadSize > MAX_PAYLOAD_BYTES) {
+        return false;
+    }
+    payload.resize(header.payloadSize);
+    return readAll(connection, payload.data(), payload.size());
+}
+
+// request: working directory, argument count, arguments, source count, then per source its
+// name and text
+bool sendRequest(int connection, const CompileRequest& request) {
+    ByteWriter writer;
+    writer.putString(request.workingDirectory);
+    writer.putValue(static_cast<uint32_t>(request.arguments.size()));
+    for (const std::string& argument : request.arguments) writer.putString(argument);
+    writer.putValue(static_cast<uint32_t>(request.sources.size()));
+    for (const InlineSource& source : request.sources) {
+        writer.putString(source.name);
+        writer.putBytes(source.text);
+    }
+    return sendFrame(connection, writer.buffer);
+}
+
+bool receiveRequest(int connection, CompileRequest& request) {
+    std::vector<char> payload;
+    if (!receiveFrame(connection, payload)) return false;
+    ByteReader reader(payload.data(), payload.size());
+
+    uint32_t count = 0;
+    if (!reader.getString(request.workingDirectory) || !reader.getValue(count)) return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        request.arguments.emplace_back();
+        if (!reader.getString(request.arguments.back())) return false;
+    }
+    if (!reader.getValue(count)) return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        request.sources.emplace_back();
+        if (!reader.getString(request.sources.back().name) || !reader.getBytes(request.sources.back().text)) {
+            return false;
+        }
+    }
+    return reader.atEnd();
+}
+
+// response: status, terminal text, log text, output directory, output count, then per output
+// its name and bytes
+bool sendResponse(int connection, const CompileResponse& response) {
+    ByteWriter writer;
+    writer.putValue(response.status);
+    writer.putString(response.terminal);
+    writer.putString(response.log);
+    writer.putString(response.outputDirectory);
+    writer.putValue(static_cast<uint32_t>(response.outputs.size()));
+    for (const ReturnedOutput& output : response.outputs) {
+        writer.putString(output.name);
+        writer.putBytes(output.bytes);
+    }
+    return sendFrame(connection, writer.buffer);
+}
+
+bool receiveResponse(int connection, CompileResponse& response) {
+    std::vector<char> payload;
+    if (!receiveFrame(connection, payload)) return false;
+    ByteReader reader(payload.data(), payload.size());
+
+    uint32_t count = 0;
+    if (!reader.getValue(response.status) || !reader.getString(response.terminal) || !reader.getString(response.log) ||
+        !reader.getString(response.outputDirectory) || !reader.getValue(count)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        response.outputs.emplace_back();
+        if (!reader.getString(response.outputs.back().name) || !reader.getBytes(response.outputs.back().bytes)) {
+            return false;
+        }
+    }
+    return reader.atEnd();
+}
+
+#ifdef HAVE_UNIX_SOCKETS
+static bool socketAddress(const std::string& socketPath, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) return false;
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    return true;
+}
+#endif
+
+int connectToServer(const std::string& socketPath) {
+#ifdef HAVE_UNIX_SOCKETS
+    sockaddr_un address;
+    if (!socketAddress(socketPath, address)) return -1;
+    int connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (connection < 0) return -1;
+    if (::connect(connection, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(connection);
+        return -1;
+    }
+    return connection;
+#else
+    (void)socketPath;
+    return -1;
+#endif
+}
+
+void closeConnection(int connection) {
+#ifdef HAVE_UNIX_SOCKETS
+    if (connection >= 0) ::close(connection);
+#else
+    (void)connection;
+#endif
+}
+
+CompileServerSocket::~CompileServerSocket() {
+#ifdef HAVE_UNIX_SOCKETS
+    if (descriptor >= 0) {
+        ::close(descriptor);
+        ::unlink(path.c_str());
+    }
+#endif
+}
+
+bool CompileServerSocket::listen(const std::string& socketPath, std::string& error) {
+#ifdef HAVE_UNIX_SOCKETS
+    sockaddr_un address;
+    if (!socketAddress(socketPath, address)) {
+        error = "socket path is too long: " + socketPath;
+        return false;
+    }
+    int live = connectToServer(socketPath);
+    if (live >= 0) {
+        ::close(live);
+        error = "a server is already listening on " + socketPath;
+        return false;
+    }
+    ::unlink(socketPath.c_str());  // left behind by a server that did not shut down
+
+    descriptor = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (descriptor < 0 ||
+        ::bind(descriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(descriptor, SOMAXCONN) != 0) {
+        error = std::string("cannot listen on ") + socketPath + ": " + std::strerror(errno);
+        if (descriptor >= 0) ::close(descriptor);
+        descriptor = -1;
+        return false;
+    }
+    path = socketPath;
+    return true;
+#else
+    (void)socketPath;
+    error = "the compile server needs Unix domain sockets";
+    return false;
+#endif
+}
+
+int CompileServerSocket::accept() {
+#ifdef HAVE_UNIX_SOCKETS
+    return ::accept(descriptor, nullptr, nullptr);
+#else
+    return -1;
+#endif
+}
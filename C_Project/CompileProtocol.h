@@ -0,0 +1,74 @@
+#ifndef COMPILE_PROTOCOL_H
+#define COMPILE_PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// requests and responses between tokenizer-client and "tokenizer --serve", and the Unix
+// domain socket they travel over. every message is one frame:
+//
+//   header    magic "TKSV", version, payload size (64-bit)
+//   payload   a CompileRequest or CompileResponse (see CompileProtocol.cpp)
+//
+// fields are in host byte order: a Unix domain socket only connects processes on the same
+// machine. one connection carries one request and its response
+const uint32_t COMPILE_PROTOCOL_VERSION = 1;
+
+// a source sent with the request instead of being read from disk
+struct InlineSource {
+    std::string name;  // file name, used for the output names
+    std::vector<char> text;
+};
+
+struct CompileRequest {
+    std::string workingDirectory;        // relative paths in arguments are relative to this
+    std::vector<std::string> arguments;  // tokenizer options and inputs, as on its command line
+    std::vector<InlineSource> sources;   // if any, these are the inputs and arguments name none
+};
+
+// an output file of an inline source, returned rather than written by the server
+struct ReturnedOutput {
+    std::string name;
+    std::vector<char> bytes;
+};
+
+struct CompileResponse {
+    int32_t status = 0;                  // the tokenizer's exit status
+    std::string terminal;                // what it would have printed to stderr
+    std::string log;                     // what it would have appended to errors.txt
+    std::string outputDirectory;         // where the outputs below belong
+    std::vector<ReturnedOutput> outputs; // only for inline sources
+};
+
+// per-user socket in the temporary directory, used when --socket/--serve name none
+std::string defaultSocketPath();
+
+// both false if the connection failed or the frame is malformed
+bool sendRequest(int connection, const CompileRequest& request);
+bool receiveRequest(int connection, CompileRequest& request);
+bool sendResponse(int connection, const CompileResponse& response);
+bool receiveResponse(int connection, CompileResponse& response);
+
+int connectToServer(const std::string& socketPath);  // the connection, or -1
+void closeConnection(int connection);
+
+// the server's listening socket. listen() refuses to take over a path a live server answers
+// on, but replaces a stale socket file left by one that died
+class CompileServerSocket {
+public:
+    CompileServerSocket() = default;
+    ~CompileServerSocket();
+
+    CompileServerSocket(const CompileServerSocket&) = delete;
+    CompileServerSocket& operator=(const CompileServerSocket&) = delete;
+
+    bool listen(const std::string& socketPath, std::string& error);
+    int accept();  // the next connection, or -1 (retry unless it keeps failing)
+
+private:
+    int descriptor = -1;
+    std::string path;
+};
+
+#endif
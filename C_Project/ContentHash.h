@@ -0,0 +1,16 @@
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 64-bit xxHash (XXH64) of length bytes. fast and well mixed, so it is good for telling whether
+// a file changed, but it is not a cryptographic hash
+uint64_t contentHash(const void* data, size_t length, uint64_t seed = 0);
+
+inline uint64_t contentHash(const std::string& text, uint64_t seed = 0) {
+    return contentHash(text.data(), text.size(), seed);
+}
+
+#endif
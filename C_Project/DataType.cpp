@@ -0,0 +1,34 @@
+#include "DataType.h"
+
+DataType dataTypeFromString(const std::string& name) {
+    if (name == "int") return TYPE_INT;
+    if (name == "char") return TYPE_CHAR;
+    if (name == "bool") return TYPE_BOOL;
+    if (name == "float") return TYPE_FLOAT;
+    if (name == "double") return TYPE_DOUBLE;
+    if (name == "void") return TYPE_VOID;
+    return TYPE_UNKNOWN;
+}
+
+const char* dataTypeToString(DataType type) {
+    switch (type) {
+        case TYPE_NONE: return "NOT APPLICABLE";
+        case TYPE_INT: return "int";
+        case TYPE_CHAR: return "char";
+        case TYPE_BOOL: return "bool";
+        case TYPE_FLOAT: return "float";
+        case TYPE_DOUBLE: return "double";
+        case TYPE_VOID: return "void";
+        default: return "UNKNOWN";
+    }
+}
+
+const char* identifierKindToString(IdentifierKind kind) {
+    switch (kind) {
+        case IDENTIFIER_FUNCTION: return "function";
+        case IDENTIFIER_PROCEDURE: return "procedure";
+        case IDENTIFIER_DATATYPE: return "datatype";
+        case IDENTIFIER_PARAMETER: return "parameter";
+        default: return "UNKNOWN";
+    }
+}
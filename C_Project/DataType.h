@@ -0,0 +1,31 @@
+#ifndef DATA_TYPE_H
+#define DATA_TYPE_H
+
+#include <cstdint>
+#include <string>
+
+// data types of the language, as stored in the symbol table
+enum DataType : uint8_t {
+    TYPE_NONE,  // procedures ("NOT APPLICABLE")
+    TYPE_INT,
+    TYPE_CHAR,
+    TYPE_BOOL,
+    TYPE_FLOAT,
+    TYPE_DOUBLE,
+    TYPE_VOID,
+    TYPE_UNKNOWN
+};
+
+// what a symbol table entry names
+enum IdentifierKind : uint8_t {
+    IDENTIFIER_FUNCTION,
+    IDENTIFIER_PROCEDURE,
+    IDENTIFIER_DATATYPE,  // a variable
+    IDENTIFIER_PARAMETER
+};
+
+DataType dataTypeFromString(const std::string& name);  // a type keyword such as "int"
+const char* dataTypeToString(DataType type);           // spelling used in the outputs
+const char* identifierKindToString(IdentifierKind kind);
+
+#endif
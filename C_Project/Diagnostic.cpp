@@ -0,0 +1,184 @@
+#include "Diagnostic.h"
+#include "Trace.h"
+#include "BinaryStringTable.h"
+#include "CSTWriter.h"
+#include "MappedFile.h"
+#include <cstring>
+
+// {n} is replaced by args[n]
+static const char* diagnosticFormat(DiagnosticCode code) {
+    switch (code) {
+        case DIAG_CANNOT_OPEN_INPUT: return "Error: Unable to open input file {0}";
+        case DIAG_CANNOT_CREATE_OUTPUT: return "Error: Unable to create output file {0}";
+        case DIAG_CANNOT_OPEN_FILE: return "Unable to open file: {0}";
+        case DIAG_EMPTY_TOKEN_LIST: return "Syntax Error: Token list generation failed. See terminal or error log.";
+
+        case DIAG_UNMATCHED_COMMENT_CLOSE: return "Lexical Error: Unmatched closing comment '*/'.";
+        case DIAG_UNTERMINATED_COMMENT: return "Lexical Error: Unterminated block comment.";
+        case DIAG_FILE_IS_COMMENT: return "Lexical Error: Entire file was enclosed in a comment.";
+        case DIAG_INVALID_IDENTIFIER: return "Syntax error: invalid identifier '{0}'";
+        case DIAG_INVALID_INTEGER: return "Syntax error: invalid integer '{0}'";
+        case DIAG_UNTERMINATED_CHAR: return "Syntax error: unterminated character literal.";
+        case DIAG_UNTERMINATED_CHAR_AT_EOF: return "Syntax error: unterminated character literal at end of file.";
+        case DIAG_UNTERMINATED_STRING: return "Syntax error: unterminated string literal starting here.";
+        case DIAG_UNKNOWN_TOKEN: return "Unknown token encountered: '{0}'";
+
+        case DIAG_EXPECTED_RETURN_TYPE: return "Expected return type after 'function'.";
+        case DIAG_EXPECTED_STATEMENT_AT_START: return "Expected valid statement at start of program.";
+        case DIAG_RESERVED_FUNCTION_NAME: return "Syntax error: cannot define a function with reserved word '{0}'";
+        case DIAG_EXPECTED_DEFINITION_NAME: return "Expected procedure or function name.";
+        case DIAG_EXPECTED_PARAMETER_LIST: return "Expected '(' after procedure or function name.";
+        case DIAG_EXPECTED_PARAMETER_TYPE: return "Expected parameter type or ')' in parameter list.";
+        case DIAG_EXPECTED_CLOSE_AFTER_VOID: return "Expected ')' after 'void'.";
+        case DIAG_EXPECTED_PARAMETER_ARRAY_SIZE: return "Expected integer size for array parameter.";
+        case DIAG_EXPECTED_CLOSE_ARRAY_SIZE: return "Expected ']' after array size.";
+        case DIAG_RESERVED_PARAMETER_NAME: return "Syntax error: reserved word '{0}' cannot be used as a parameter name.";
+        case DIAG_EXPECTED_PARAMETER_NAME: return "Expected parameter name after type.";
+        case DIAG_EXPECTED_BODY: return "Expected '{' at the start of procedure or function body.";
+        case DIAG_EXPECTED_FOR_OPEN: return "Expected '(' after 'for'.";
+        case DIAG_EXPECTED_FOR_SEMICOLON: return "Expected ';' after 'for' loop condition.";
+        case DIAG_EXPECTED_FOR_INCREMENT: return "Expected increment expression (i++, i--, or assignment) in 'for' loop increment.";
+        case DIAG_EXPECTED_FOR_CLOSE: return "Expected ')' after 'for' loop header.";
+        case DIAG_EXPECTED_FOR_BODY: return "Expected '{' after 'for' loop header.";
+        case DIAG_RESERVED_VARIABLE_NAME: return "Syntax error: reserved word '{0}' cannot be used as a variable name.";
+        case DIAG_EXPECTED_SIGNED_ARRAY_SIZE: return "Expected integer after '+' or '-' in array size.";
+        case DIAG_EXPECTED_ARRAY_SIZE: return "Expected integer size for array declaration.";
+        case DIAG_ARRAY_SIZE_NOT_POSITIVE: return "Syntax error: array declaration size must be a positive integer.";
+        case DIAG_EXPECTED_VARIABLE_NAME: return "Expected variable name after type.";
+        case DIAG_EXPECTED_DECLARATION_SEMICOLON: return "Expected ';' after variable declaration.";
+        case DIAG_EXPECTED_CLOSE_ARRAY_INDEX: return "Expected ']' after array index.";
+        case DIAG_EXPECTED_ELEMENT_ASSIGNMENT: return "Expected '=' after array element.";
+        case DIAG_EXPECTED_ASSIGNMENT_SEMICOLON: return "Expected ';' after assignment.";
+        case DIAG_EXPECTED_ASSIGNMENT_STATEMENT_SEMICOLON: return "Expected ';' after assignment statement.";
+        case DIAG_EXPECTED_CALL_SEMICOLON: return "Expected ';' after function call.";
+        case DIAG_INVALID_STATEMENT: return "Invalid statement.";
+        case DIAG_EXPECTED_IF_OPEN: return "Expected '(' after 'if' keyword.";
+        case DIAG_EXPECTED_IF_CLOSE: return "Expected ')' after 'if' condition.";
+        case DIAG_EXPECTED_IF_BODY: return "Expected '{' after 'if' condition.";
+        case DIAG_EXPECTED_ELSE_BODY: return "Expected '{' after 'else' keyword.";
+        case DIAG_EXPECTED_RETURN_SEMICOLON: return "Expected ';' after return statement.";
+        case DIAG_EXPECTED_WHILE_OPEN: return "Expected '(' after 'while' keyword.";
+        case DIAG_EXPECTED_WHILE_CLOSE: return "Expected ')' after 'while' condition.";
+        case DIAG_EXPECTED_WHILE_BODY: return "Expected '{' after 'while' condition.";
+        case DIAG_EXPECTED_DECLARATION_IDENTIFIER: return "Expected identifier in declaration.";
+        case DIAG_EXPECTED_ASSIGNMENT_OPERATOR: return "Expected '=' in assignment statement.";
+        case DIAG_EXPECTED_ARGUMENT_SEPARATOR: return "Expected ',' or ')' in function call argument list.";
+        case DIAG_EXPECTED_CLOSE_PAREN: return "Expected ')' after expression.";
+        case DIAG_INVALID_ESCAPE: return "Invalid or unrecognized escape sequence: \\{0}";
+        case DIAG_INVALID_EXPRESSION: return "Invalid expression.";
+        case DIAG_EXPECTED_OPERAND: return "Expected integer or identifier in expression.";
+
+        case DIAG_DUPLICATE_LOCAL: return "variable \"{0}\" is already defined locally";
+        case DIAG_DUPLICATE_GLOBAL: return "variable \"{0}\" is already defined globally";
+        case DIAG_DUPLICATE_ACROSS_FILES: return "\"{0}\" is already defined globally in {1} (line {2})";
+
+        case DIAG_UNDEFINED_VARIABLE: return "variable \"{0}\" is not defined";
+        case DIAG_UNDEFINED_FUNCTION: return "function \"{0}\" is not defined";
+        case DIAG_FUNCTION_NOT_IN_ANY_FILE: return "function \"{0}\" is not defined in any file";
+
+        case DIAG_UNARY_OPERAND: return "operator \"{0}\" cannot be applied to {1}";
+        case DIAG_BINARY_OPERANDS: return "operator \"{0}\" cannot be applied to {1} and {2}";
+        case DIAG_INDEX_NOT_INT: return "array index of \"{0}\" must be an integer, got {1}";
+        case DIAG_NOT_AN_ARRAY: return "variable \"{0}\" is not an array";
+        case DIAG_ARGUMENT_TYPE: return "argument {0} of \"{1}\" expects {2}, got {3}";
+        case DIAG_ARGUMENT_COUNT: return "function \"{0}\" expects {1} argument(s), got {2}";
+        case DIAG_ASSIGN_TYPE: return "cannot assign {0} to \"{1}\" of type {2}";
+        case DIAG_PROCEDURE_RETURNS_VALUE: return "procedure \"{0}\" cannot return a value";
+        case DIAG_RETURN_TYPE: return "function \"{0}\" returns {1}, got {2}";
+        case DIAG_CONDITION_TYPE: return "condition must be bool or a number, got {0}";
+    }
+    return "unknown diagnostic";
+}
+
+std::string formatDiagnostic(const Diagnostic& diagnostic) {
+    std::string message;
+    for (const char* c = diagnosticFormat(diagnostic.code); *c; ++c) {
+        if (c[0] == '{' && c[1] >= '0' && c[1] <= '9' && c[2] == '}') {
+            size_t slot = c[1] - '0';
+            if (slot < diagnostic.argCount) message += diagnostic.args[slot];
+            c += 2;
+        } else {
+            message += *c;
+        }
+    }
+    return message;
+}
+
+std::string diagnosticCodeId(DiagnosticCode code) {
+    return "E" + std::to_string(static_cast<int>(code));
+}
+
+const char* severityToString(Severity severity) {
+    switch (severity) {
+        case SEVERITY_ERROR: return "error";
+        case SEVERITY_WARNING: return "warning";
+        case SEVERITY_NOTE: return "note";
+    }
+    return "error";
+}
+
+void writeDiagnosticsJson(const std::vector<DiagnosticFile>& files, std::ostream& out) {
+    TRACE_SCOPE("writeDiagnosticsJson");
+    out << "[";
+    bool first = true;
+    for (const DiagnosticFile& file : files) {
+        for (const Diagnostic& diagnostic : file.diagnostics) {
+            out << (first ? "\n  " : ",\n  ");
+            first = false;
+
+            out << "{\"file\": ";
+            writeJsonString(out, file.file);
+            out << ", \"code\": \"" << diagnosticCodeId(diagnostic.code) << "\"";
+            out << ", \"severity\": \"" << severityToString(diagnostic.severity) << "\"";
+            const SourceRange& range = diagnostic.range;
+            out << ", \"range\": [" << range.line << ", " << range.column << ", " << range.endLine << ", "
+                << range.endColumn << "]";
+            out << ", \"args\": [";
+            for (size_t i = 0; i < diagnostic.argCount; ++i) {
+                if (i > 0) out << ", ";
+                writeJsonString(out, diagnostic.args[i]);
+            }
+            out << "], \"message\": ";
+            writeJsonString(out, formatDiagnostic(diagnostic));
+            out << "}";
+        }
+    }
+    out << "\n]\n";
+}
+
+bool writeDiagnosticsBinary(const std::vector<DiagnosticFile>& files, const std::string& path) {
+    TRACE_SCOPE("writeDiagnosticsBinary");
+    BinaryStringTableBuilder strings;
+    std::vector<DiagnosticBinaryRecord> records;
+    std::vector<uint32_t> arguments;
+
+    for (const DiagnosticFile& file : files) {
+        uint32_t fileName = strings.add(file.file);
+        for (const Diagnostic& diagnostic : file.diagnostics) {
+            records.push_back({fileName, static_cast<uint16_t>(diagnostic.code), diagnostic.severity,
+                               diagnostic.argCount, diagnostic.range, static_cast<uint32_t>(arguments.size())});
+            for (size_t i = 0; i < diagnostic.argCount; ++i) arguments.push_back(strings.add(diagnostic.args[i]));
+        }
+    }
+
+    DiagnosticBinaryHeader header;
+    std::memcpy(header.magic, "DIAG", 4);
+    header.version = DIAGNOSTIC_BINARY_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.recordCount = static_cast<uint32_t>(records.size());
+    header.argumentCount = static_cast<uint32_t>(arguments.size());
+    header.stringCount = strings.count();
+    header.stringBytes = strings.byteCount();
+    header.recordOffset = sizeof(DiagnosticBinaryHeader);
+    header.argumentOffset = header.recordOffset + header.recordCount * sizeof(DiagnosticBinaryRecord);
+    header.stringOffsetsOffset = header.argumentOffset + header.argumentCount * sizeof(uint32_t);
+    header.stringDataOffset = header.stringOffsetsOffset + static_cast<uint32_t>(strings.offsetsSize());
+
+    std::vector<char> buffer(header.stringDataOffset + header.stringBytes);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    if (!records.empty()) std::memcpy(buffer.data() + header.recordOffset, records.data(), records.size() * sizeof(DiagnosticBinaryRecord));
+    if (!arguments.empty()) std::memcpy(buffer.data() + header.argumentOffset, arguments.data(), arguments.size() * sizeof(uint32_t));
+    strings.copyOffsets(buffer.data() + header.stringOffsetsOffset);
+    strings.copyData(buffer.data() + header.stringDataOffset);
+    return writeWholeFile(path, buffer);
+}
@@ -0,0 +1,194 @@
+#ifndef DIAGNOSTIC_H
+#define DIAGNOSTIC_H
+
+#include "ByteOrder.h"
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// every error the front end reports. the number is the stable id written to the JSON and
+// binary outputs (E<number>); the message text of each code lives in Diagnostic.cpp and is
+// only built when a diagnostic is printed or serialized
+enum DiagnosticCode : uint16_t {
+    // files
+    DIAG_CANNOT_OPEN_INPUT = 1,
+    DIAG_CANNOT_CREATE_OUTPUT = 2,
+    DIAG_CANNOT_OPEN_FILE = 3,
+    DIAG_EMPTY_TOKEN_LIST = 4,
+
+    // comments and tokens
+    DIAG_UNMATCHED_COMMENT_CLOSE = 100,
+    DIAG_UNTERMINATED_COMMENT = 101,
+    DIAG_FILE_IS_COMMENT = 102,
+    DIAG_INVALID_IDENTIFIER = 103,
+    DIAG_INVALID_INTEGER = 104,
+    DIAG_UNTERMINATED_CHAR = 105,
+    DIAG_UNTERMINATED_CHAR_AT_EOF = 106,
+    DIAG_UNTERMINATED_STRING = 107,
+    DIAG_UNKNOWN_TOKEN = 108,
+
+    // syntax
+    DIAG_EXPECTED_RETURN_TYPE = 200,
+    DIAG_EXPECTED_STATEMENT_AT_START = 201,
+    DIAG_RESERVED_FUNCTION_NAME = 202,
+    DIAG_EXPECTED_DEFINITION_NAME = 203,
+    DIAG_EXPECTED_PARAMETER_LIST = 204,
+    DIAG_EXPECTED_PARAMETER_TYPE = 205,
+    DIAG_EXPECTED_CLOSE_AFTER_VOID = 206,
+    DIAG_EXPECTED_PARAMETER_ARRAY_SIZE = 207,
+    DIAG_EXPECTED_CLOSE_ARRAY_SIZE = 208,
+    DIAG_RESERVED_PARAMETER_NAME = 209,
+    DIAG_EXPECTED_PARAMETER_NAME = 210,
+    DIAG_EXPECTED_BODY = 211,
+    DIAG_EXPECTED_FOR_OPEN = 212,
+    DIAG_EXPECTED_FOR_SEMICOLON = 213,
+    DIAG_EXPECTED_FOR_INCREMENT = 214,
+    DIAG_EXPECTED_FOR_CLOSE = 215,
+    DIAG_EXPECTED_FOR_BODY = 216,
+    DIAG_RESERVED_VARIABLE_NAME = 217,
+    DIAG_EXPECTED_SIGNED_ARRAY_SIZE = 218,
+    DIAG_EXPECTED_ARRAY_SIZE = 219,
+    DIAG_ARRAY_SIZE_NOT_POSITIVE = 220,
+    DIAG_EXPECTED_VARIABLE_NAME = 221,
+    DIAG_EXPECTED_DECLARATION_SEMICOLON = 222,
+    DIAG_EXPECTED_CLOSE_ARRAY_INDEX = 223,
+    DIAG_EXPECTED_ELEMENT_ASSIGNMENT = 224,
+    DIAG_EXPECTED_ASSIGNMENT_SEMICOLON = 225,
+    DIAG_EXPECTED_ASSIGNMENT_STATEMENT_SEMICOLON = 226,
+    DIAG_EXPECTED_CALL_SEMICOLON = 227,
+    DIAG_INVALID_STATEMENT = 228,
+    DIAG_EXPECTED_IF_OPEN = 229,
+    DIAG_EXPECTED_IF_CLOSE = 230,
+    DIAG_EXPECTED_IF_BODY = 231,
+    DIAG_EXPECTED_ELSE_BODY = 232,
+    DIAG_EXPECTED_RETURN_SEMICOLON = 233,
+    DIAG_EXPECTED_WHILE_OPEN = 234,
+    DIAG_EXPECTED_WHILE_CLOSE = 235,
+    DIAG_EXPECTED_WHILE_BODY = 236,
+    DIAG_EXPECTED_DECLARATION_IDENTIFIER = 237,
+    DIAG_EXPECTED_ASSIGNMENT_OPERATOR = 238,
+    DIAG_EXPECTED_ARGUMENT_SEPARATOR = 239,
+    DIAG_EXPECTED_CLOSE_PAREN = 240,
+    DIAG_INVALID_ESCAPE = 241,
+    DIAG_INVALID_EXPRESSION = 242,
+    DIAG_EXPECTED_OPERAND = 243,
+
+    // declarations
+    DIAG_DUPLICATE_LOCAL = 300,
+    DIAG_DUPLICATE_GLOBAL = 301,
+    DIAG_DUPLICATE_ACROSS_FILES = 302,
+
+    // names
+    DIAG_UNDEFINED_VARIABLE = 400,
+    DIAG_UNDEFINED_FUNCTION = 401,
+    DIAG_FUNCTION_NOT_IN_ANY_FILE = 402,
+
+    // types
+    DIAG_UNARY_OPERAND = 500,
+    DIAG_BINARY_OPERANDS = 501,
+    DIAG_INDEX_NOT_INT = 502,
+    DIAG_NOT_AN_ARRAY = 503,
+    DIAG_ARGUMENT_TYPE = 504,
+    DIAG_ARGUMENT_COUNT = 505,
+    DIAG_ASSIGN_TYPE = 506,
+    DIAG_PROCEDURE_RETURNS_VALUE = 507,
+    DIAG_RETURN_TYPE = 508,
+    DIAG_CONDITION_TYPE = 509
+};
+
+enum Severity : uint8_t {
+    SEVERITY_ERROR,
+    SEVERITY_WARNING,
+    SEVERITY_NOTE
+};
+
+// lines and columns are 1-based; 0 means unknown (tokens only carry a line so far)
+struct SourceRange {
+    int32_t line;
+    int32_t column;
+    int32_t endLine;
+    int32_t endColumn;
+};
+
+const size_t DIAGNOSTIC_MAX_ARGS = 4;
+
+// one reported problem: the code picks the message, args fill its {0}..{3} slots
+struct Diagnostic {
+    DiagnosticCode code;
+    Severity severity;
+    uint8_t argCount;
+    SourceRange range;
+    std::array<std::string, DIAGNOSTIC_MAX_ARGS> args;
+};
+
+inline void setDiagnosticArg(std::string& slot, const std::string& value) { slot = value; }
+inline void setDiagnosticArg(std::string& slot, const char* value) { slot = value; }
+inline void setDiagnosticArg(std::string& slot, long long value) { slot = std::to_string(value); }
+
+// an error on a single line; args are copied into the slots as they are, nothing is formatted
+template <typename... Args>
+Diagnostic makeDiagnostic(DiagnosticCode code, int line, const Args&... args) {
+    static_assert(sizeof...(Args) <= DIAGNOSTIC_MAX_ARGS, "too many diagnostic arguments");
+    Diagnostic diagnostic;
+    diagnostic.code = code;
+    diagnostic.severity = SEVERITY_ERROR;
+    diagnostic.argCount = static_cast<uint8_t>(sizeof...(Args));
+    diagnostic.range = {line, 0, line, 0};
+    size_t slot = 0;
+    (setDiagnosticArg(diagnostic.args[slot++], args), ...);
+    return diagnostic;
+}
+
+std::string formatDiagnostic(const Diagnostic& diagnostic);  // the message text, without the line
+std::string diagnosticCodeId(DiagnosticCode code);           // "E" + number, e.g. E104
+const char* severityToString(Severity severity);
+
+// the diagnostics of one input file, as collected for the JSON and binary outputs
+struct DiagnosticFile {
+    std::string file;
+    std::vector<Diagnostic> diagnostics;
+};
+
+// [{"file", "code", "severity", "range", "args", "message"}, ...] in file order
+void writeDiagnosticsJson(const std::vector<DiagnosticFile>& files, std::ostream& out);
+
+// binary diagnostics format (diagnostics.bin), host byte order:
+//
+//   header       magic "DIAG", version, BYTE_ORDER_MARK, record count, argument count, string
+//                count and bytes, then the section offsets
+//   records      fixed-size {file, code, severity, argCount, range, first argument}
+//   arguments    string ids; a record's args are argCount consecutive entries from its first
+//   strings      file names and argument text (see BinaryStringTable.h)
+//
+// messages are not stored: readers format them from the code and the args. a reader checks
+// the version and byte-order mark before anything else
+const uint32_t DIAGNOSTIC_BINARY_VERSION = 2;
+
+struct DiagnosticBinaryHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t recordCount;
+    uint32_t argumentCount;
+    uint32_t stringCount;
+    uint32_t stringBytes;
+    uint32_t recordOffset;
+    uint32_t argumentOffset;
+    uint32_t stringOffsetsOffset;
+    uint32_t stringDataOffset;
+};
+
+struct DiagnosticBinaryRecord {
+    uint32_t file;
+    uint16_t code;
+    uint8_t severity;
+    uint8_t argCount;
+    SourceRange range;
+    uint32_t firstArgument;
+};
+
+bool writeDiagnosticsBinary(const std::vector<DiagnosticFile>& files, const std::string& path);
+
+#endif
@@ -1,44 +1,69 @@
 #include "ErrorHandler.h"
 
-// Define the global instance
-ErrorHandler errorHandler;
-
-void ErrorHandler::addError(int line, const std::string& message) {
-    errors.push_back({line, message});
+void ErrorHandler::add(const Diagnostic& diagnostic) {
+    diagnostics.push_back(diagnostic);
+    if (diagnostic.severity == SEVERITY_ERROR) errorCount++;
 }
 
-void ErrorHandler::printErrors() const {
-    if (errors.empty()) return;
+void ErrorHandler::printErrors(std::ostream& out) const {
+    if (diagnostics.empty()) return;
 
-    std::cerr << "Errors encountered:\n";
+    out << "Errors encountered:\n";
 
-    for (const auto& error : errors) {
-        std::cerr << "Line " << error.first << ": " << error.second << "\n";
+    for (const auto& diagnostic : diagnostics) {
+        out << "Line " << diagnostic.range.line << ": " << formatDiagnostic(diagnostic) << "\n";
     }
+}
 
-    writeErrorsToFile("errors.txt");  // Ensure errors get logged to file
+void ErrorHandler::appendErrors(const ErrorHandler& other) {
+    diagnostics.insert(diagnostics.end(), other.diagnostics.begin(), other.diagnostics.end());
+    errorCount += other.errorCount;
 }
 
-void ErrorHandler::writeErrorsToFile(const std::string& filename) const {
-    if (errors.empty()) {
-        return;
-    }
+void ErrorHandler::clearErrors() {
+    diagnostics.clear();
+    errorCount = 0;
+}
+
+// opens the log the first time something is written, so a clean run leaves no errors.txt behind
+bool ErrorLog::openLocked() {
+    if (out) return true;
+    if (openFailed) return false;
 
-    std::ofstream errorFile(filename, std::ios::app); // Append errors
-    if (!errorFile) {
+    file.open(filename, std::ios::app); // Append errors
+    if (!file) {
         std::cerr << "[ERROR] Unable to open error log file: " << filename << "\n";
-        return; 
+        openFailed = true;  // reported once, not once per file
+        return false;
     }
+    out = &file;
+    return true;
+}
 
+void ErrorLog::write(const ErrorHandler& errors, const std::string& unit) {
+    if (errors.getDiagnostics().empty()) return;
 
-    for (const auto& error : errors) {
-        errorFile << "Line " << error.first << ": " << error.second << "\n";
+    std::lock_guard<std::mutex> lock(mutex);
+    if (keep) kept.push_back({unit, errors.getDiagnostics()});
+    if (!openLocked()) return;
+    for (const auto& diagnostic : errors.getDiagnostics()) {
+        *out << "Line " << diagnostic.range.line << ": " << formatDiagnostic(diagnostic) << "\n";
     }
+}
 
-    errorFile.close();
+void ErrorLog::writeLine(const std::string& line) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!openLocked()) return;
+    *out << line << "\n";
 }
 
-void ErrorHandler::clearErrors() {
-    errors.clear();
+void ErrorLog::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (out) out->flush();
+}
+
+void ErrorAggregator::merge(size_t unit, const ErrorHandler& errors) {
+    std::lock_guard<std::mutex> lock(mutex);
+    units[unit].appendErrors(errors);
 }
 
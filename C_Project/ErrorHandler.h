@@ -1,25 +1,86 @@
 #ifndef ERROR_HANDLER_H
 #define ERROR_HANDLER_H
 
+#include "Diagnostic.h"
 #include <vector>
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <mutex>
 
+// the diagnostics of one compilation unit. every phase (CommentRemover, Tokenizer, Parser,
+// NameResolver, ...) is handed the unit's ErrorHandler explicitly; there is no shared instance
 class ErrorHandler {
 private:
-    std::vector<std::pair<int, std::string>> errors;
+    std::vector<Diagnostic> diagnostics;
+    size_t errorCount = 0;
 
 public:
-    void addError(int line, const std::string& message);
-    void printErrors() const;
+    // records code with its arguments; the message is only formatted when printed or logged
+    template <typename... Args>
+    void report(DiagnosticCode code, int line, const Args&... args) {
+        add(makeDiagnostic(code, line, args...));
+    }
+    void add(const Diagnostic& diagnostic);
+    void printErrors(std::ostream& out = std::cerr) const;  // to the terminal only; the log file goes through ErrorLog
     void clearErrors();
-    void writeErrorsToFile(const std::string& filename) const;
-    bool hasErrors() const { return !errors.empty(); }
+    bool hasErrors() const { return errorCount > 0; }
+    const std::vector<Diagnostic>& getDiagnostics() const { return diagnostics; }
+    void appendErrors(const ErrorHandler& other);  // keeps other's order, used when merging partial parses
     
 };
 
-// Declare the global instance
-extern ErrorHandler errorHandler;
+// gathers the ErrorHandlers of several units that are processed concurrently. each unit
+// has a fixed slot, so the merged result is in unit order no matter which thread finishes first
+class ErrorAggregator {
+public:
+    explicit ErrorAggregator(size_t unitCount) : units(unitCount) {}
+
+    void merge(size_t unit, const ErrorHandler& errors);  // thread-safe, appends to the unit's slot
+    // read these only once every merge is done
+    const ErrorHandler& getErrors(size_t unit) const { return units[unit]; }
+    bool hasErrors(size_t unit) const { return units[unit].hasErrors(); }
+    size_t size() const { return units.size(); }
+
+private:
+    std::mutex mutex;
+    std::vector<ErrorHandler> units;
+};
+
+// the run's error log (errors.txt). the file is opened once, in append mode, on the first
+// write and kept open; entries are buffered and reach the disk on flush() or when the log
+// is destroyed. every ErrorHandler passed to write() is logged exactly once
+class ErrorLog {
+public:
+    explicit ErrorLog(const std::string& filename) : filename(filename) {}
+    // logs to log instead of a file and names terminal as the place errors are printed, so a
+    // run's messages can be collected (the compile server sends them to its client)
+    ErrorLog(std::ostream& log, std::ostream& terminal) : out(&log), terminal(&terminal) {}
+    ~ErrorLog() { flush(); }
+
+    ErrorLog(const ErrorLog&) = delete;
+    ErrorLog& operator=(const ErrorLog&) = delete;
+
+    void write(const ErrorHandler& errors, const std::string& unit);  // thread-safe
+    void writeLine(const std::string& line);   // thread-safe, e.g. a "File: <name>" header
+    void flush();
+    std::ostream& getTerminal() const { return *terminal; }  // std::cerr unless given
+
+    // also keep every written diagnostic, by unit, for the JSON/binary outputs
+    void keepDiagnostics() { keep = true; }
+    const std::vector<DiagnosticFile>& getKeptDiagnostics() const { return kept; }
+
+private:
+    bool openLocked();
+
+    std::string filename;
+    std::ofstream file;
+    std::ostream* out = nullptr;  // file once it is open, or the stream given
+    std::ostream* terminal = &std::cerr;
+    bool openFailed = false;
+    bool keep = false;
+    std::vector<DiagnosticFile> kept;
+    std::mutex mutex;
+};
 
 #endif // ERROR_HANDLER_H
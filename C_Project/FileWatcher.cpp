@@ -0,0 +1,86 @@
+#include "FileWatcher.h"
+#include <algorithm>
+
+#ifdef __linux__
+#define HAVE_INOTIFY 1
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::~FileWatcher() {
+#ifdef HAVE_INOTIFY
+    if (descriptor >= 0) ::close(descriptor);
+#endif
+}
+
+bool FileWatcher::open() {
+#ifdef HAVE_INOTIFY
+    descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    return descriptor >= 0;
+#else
+    return false;
+#endif
+}
+
+bool FileWatcher::watchDirectory(const std::string& directory) {
+#ifdef HAVE_INOTIFY
+    // IN_CLOSE_WRITE rather than IN_MODIFY: a save is reported once, when the file is complete
+    int watch = inotify_add_watch(descriptor, directory.c_str(),
+                                  IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE);
+    if (watch < 0) return false;
+    directories[watch] = directory;
+    return true;
+#else
+    (void)directory;
+    return false;
+#endif
+}
+
+// drains the events that are ready; the descriptor is non-blocking, so this never waits
+bool FileWatcher::readEvents(std::vector<std::string>& changed) {
+#ifdef HAVE_INOTIFY
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (true) {
+        ssize_t length = ::read(descriptor, buffer, sizeof(buffer));
+        if (length < 0) return errno == EAGAIN || errno == EINTR;
+        for (char* p = buffer; p < buffer + length; ) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+            auto directory = directories.find(event->wd);
+            if (directory != directories.end() && event->len > 0) {
+                changed.push_back(directory->second + "/" + event->name);
+            }
+            p += sizeof(inotify_event) + event->len;
+        }
+    }
+#else
+    (void)changed;
+    return false;
+#endif
+}
+
+bool FileWatcher::waitForChanges(int debounceMilliseconds, std::vector<std::string>& changed) {
+    changed.clear();
+#ifdef HAVE_INOTIFY
+    pollfd ready = {descriptor, POLLIN, 0};
+    int timeout = -1;  // the first event may take forever, the ones after it only the debounce time
+    while (true) {
+        int count = poll(&ready, 1, timeout);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (count == 0) break;  // quiet for the whole debounce time
+        if (!readEvents(changed)) return false;
+        timeout = debounceMilliseconds;
+    }
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    return true;
+#else
+    (void)debounceMilliseconds;
+    return false;
+#endif
+}
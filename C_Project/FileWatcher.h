@@ -0,0 +1,34 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+// reports files that were written, moved in or out, or deleted in a set of directories
+// (not their subdirectories). uses inotify, so it only works on Linux; elsewhere open()
+// fails
+class FileWatcher {
+public:
+    FileWatcher() = default;
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool open();
+    bool watchDirectory(const std::string& directory);
+
+    // blocks until something changes, then keeps collecting until nothing has happened for
+    // debounceMilliseconds, so an editor's write + rename arrives as one batch. changed gets
+    // the paths (directory/name) touched, sorted and without duplicates. false on an error
+    bool waitForChanges(int debounceMilliseconds, std::vector<std::string>& changed);
+
+private:
+    bool readEvents(std::vector<std::string>& changed);
+
+    int descriptor = -1;
+    std::map<int, std::string> directories;  // watch descriptor -> directory as given
+};
+
+#endif
@@ -0,0 +1,96 @@
+#include "FrameLayout.h"
+#include "Trace.h"
+#include <algorithm>
+#include <unordered_map>
+
+int dataTypeSize(DataType dataType) {
+    switch (dataType) {
+        case TYPE_CHAR:
+        case TYPE_BOOL: return 1;
+        case TYPE_INT:
+        case TYPE_FLOAT: return 4;
+        default: return 8;  // double, and anything else gets a full word
+    }
+}
+
+static int alignUp(int value, int alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// arrays are passed by reference, so an array parameter is one pointer
+static FrameSlot makeSlot(const SymbolTableEntry& entry, bool isParameter) {
+    int elementSize = dataTypeSize(entry.dataType);
+    int size = elementSize;
+    if (entry.isArray) size = isParameter ? 8 : elementSize * std::max(entry.arraySize, 1);
+    return FrameSlot{&entry, isParameter, 0, size};
+}
+
+static int placeSlot(FrameSlot slot, int offset, std::vector<FrameSlot>& slots) {
+    int alignment = slot.isParameter && slot.entry->isArray ? 8 : dataTypeSize(slot.entry->dataType);
+    slot.offset = alignUp(offset, alignment);
+    slots.push_back(slot);
+    return slot.offset + slot.size;
+}
+
+struct ScopeTree {
+    std::unordered_map<int, std::vector<const SymbolTableEntry*>> locals;  // scope -> declarations
+    std::unordered_map<int, std::vector<int>> blocks;                      // scope -> nested block scopes
+};
+
+// lays out scope's locals from offset, then overlays its blocks; returns the high-water mark
+static int placeScope(const ScopeTree& tree, int scope, int offset, std::vector<FrameSlot>& slots) {
+    auto locals = tree.locals.find(scope);
+    if (locals != tree.locals.end()) {
+        for (const SymbolTableEntry* entry : locals->second) offset = placeSlot(makeSlot(*entry, false), offset, slots);
+    }
+
+    int end = offset;
+    auto blocks = tree.blocks.find(scope);
+    if (blocks != tree.blocks.end()) {
+        for (int block : blocks->second) end = std::max(end, placeScope(tree, block, offset, slots));
+    }
+    return end;
+}
+
+std::vector<FrameLayout> computeFrameLayouts(const SymbolTable& table) {
+    TRACE_SCOPE("computeFrameLayouts");
+    ScopeTree tree;
+    for (size_t i = 0; i < table.getEntryCount(); ++i) {
+        const SymbolTableEntry& entry = table.getEntry(i);
+        if (entry.identifierType == IDENTIFIER_DATATYPE && entry.scope != 0) tree.locals[entry.scope].push_back(&entry);
+    }
+    // a scope without an owner is a block inside its parent's frame
+    for (int scope = 1; scope < table.getScopeCount(); ++scope) {
+        if (table.getScopeOwner(scope).empty()) tree.blocks[table.getParentScope(scope)].push_back(scope);
+    }
+
+    std::vector<FrameLayout> layouts;
+    for (size_t i = 0; i < table.getEntryCount(); ++i) {
+        const SymbolTableEntry& entry = table.getEntry(i);
+        if (entry.identifierType != IDENTIFIER_PROCEDURE && entry.identifierType != IDENTIFIER_FUNCTION) continue;
+
+        FrameLayout layout{entry.identifierName, entry.scope, {}, 0, 0};
+        int offset = 0;
+        if (const std::vector<SymbolTableEntry>* params = table.getParameterList(entry.identifierName)) {
+            for (const SymbolTableEntry& param : *params) offset = placeSlot(makeSlot(param, true), offset, layout.slots);
+        }
+        layout.parameterSize = offset;
+        layout.frameSize = alignUp(placeScope(tree, entry.scope, offset, layout.slots), FRAME_ALIGNMENT);
+        layouts.push_back(layout);
+    }
+    return layouts;
+}
+
+void printFrameLayouts(const std::vector<FrameLayout>& layouts, std::ostream& out) {
+    TRACE_SCOPE("printFrameLayouts");
+    for (const FrameLayout& layout : layouts) {
+        out << "FRAME FOR: " << layout.functionName << "\n";
+        out << "FRAME_SIZE: " << layout.frameSize << "\n";
+        out << "PARAMETER_SIZE: " << layout.parameterSize << "\n";
+        for (const FrameSlot& slot : layout.slots) {
+            out << "  " << (slot.isParameter ? "PARAMETER " : "LOCAL     ") << slot.entry->identifierName
+                << " OFFSET: " << slot.offset << " SIZE: " << slot.size << " SCOPE: " << slot.entry->scope << "\n";
+        }
+        out << "\n";
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef FRAME_LAYOUT_H
+#define FRAME_LAYOUT_H
+
+#include "SymbolTable.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// one parameter or local variable placed in a procedure/function frame
+struct FrameSlot {
+    const SymbolTableEntry* entry;  // points into the SymbolTable the layout was computed from
+    bool isParameter;
+    int offset;  // bytes from the start of the frame
+    int size;    // bytes, the whole array for array locals
+};
+
+// concrete frame for one procedure/function: parameters first (parameter-list order),
+// then the locals of the function's own scope, then nested block scopes. sibling blocks
+// are never live at the same time, so they all start at the same offset and share space
+struct FrameLayout {
+    std::string functionName;
+    int scope;
+    std::vector<FrameSlot> slots;
+    int parameterSize;  // bytes taken by the parameters
+    int frameSize;      // bytes for one activation, a multiple of FRAME_ALIGNMENT
+};
+
+const int FRAME_ALIGNMENT = 8;
+
+int dataTypeSize(DataType dataType);
+
+// layouts in declaration order of the procedures/functions
+std::vector<FrameLayout> computeFrameLayouts(const SymbolTable& table);
+void printFrameLayouts(const std::vector<FrameLayout>& layouts, std::ostream& out);
+
+#endif
@@ -0,0 +1,58 @@
+#include "GlobalIndex.h"
+#include <algorithm>
+#include <functional>
+
+// file/line order makes reports independent of which thread added first
+static bool definedEarlier(const GlobalDefinition& a, const GlobalDefinition& b) {
+    if (a.file != b.file) return a.file < b.file;
+    return a.line < b.line;
+}
+
+GlobalIndex::GlobalIndex(size_t shardCount)
+    : shards(new Shard[std::max<size_t>(shardCount, 1)]), shardCount(std::max<size_t>(shardCount, 1)) {}
+
+GlobalIndex::Shard& GlobalIndex::shardFor(const std::string& name) const {
+    return shards[std::hash<std::string>()(name) % shardCount];
+}
+
+void GlobalIndex::add(const GlobalDefinition& definition) {
+    Shard& shard = shardFor(definition.name);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.definitions[definition.name].push_back(definition);
+}
+
+std::vector<GlobalDefinition> GlobalIndex::find(const std::string& name) const {
+    Shard& shard = shardFor(name);
+    std::vector<GlobalDefinition> result;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto found = shard.definitions.find(name);
+        if (found != shard.definitions.end()) result = found->second;
+    }
+    std::sort(result.begin(), result.end(), definedEarlier);
+    return result;
+}
+
+std::vector<GlobalDefinition> GlobalIndex::all() const {
+    std::vector<GlobalDefinition> result;
+    for (size_t i = 0; i < shardCount; ++i) {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        for (const auto& name : shards[i].definitions) {
+            result.insert(result.end(), name.second.begin(), name.second.end());
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const GlobalDefinition& a, const GlobalDefinition& b) {
+        if (a.name != b.name) return a.name < b.name;
+        return definedEarlier(a, b);
+    });
+    return result;
+}
+
+size_t GlobalIndex::size() const {
+    size_t count = 0;
+    for (size_t i = 0; i < shardCount; ++i) {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        for (const auto& name : shards[i].definitions) count += name.second.size();
+    }
+    return count;
+}
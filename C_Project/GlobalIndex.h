@@ -0,0 +1,47 @@
+#ifndef GLOBAL_INDEX_H
+#define GLOBAL_INDEX_H
+
+#include "DataType.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// a scope-0 name (global variable, procedure or function) and where it is defined
+struct GlobalDefinition {
+    std::string name;
+    IdentifierKind kind;
+    DataType dataType;
+    size_t file;  // position of the defining file in the program's file list
+    int line;
+};
+
+// global scope of a whole multi-file program. files add their definitions from any
+// thread; the table is split into independently locked shards so parallel parses
+// rarely wait on each other. readers should only run once all adds are done
+class GlobalIndex {
+public:
+    explicit GlobalIndex(size_t shardCount = 64);
+
+    void add(const GlobalDefinition& definition);  // thread-safe
+
+    // all definitions of name, ordered by file then line (empty if none)
+    std::vector<GlobalDefinition> find(const std::string& name) const;
+    // every definition, ordered by name, then file, then line
+    std::vector<GlobalDefinition> all() const;
+    size_t size() const;
+
+private:
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::vector<GlobalDefinition>> definitions;
+    };
+
+    Shard& shardFor(const std::string& name) const;
+
+    std::unique_ptr<Shard[]> shards;
+    size_t shardCount;
+};
+
+#endif
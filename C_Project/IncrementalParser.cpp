@@ -0,0 +1,226 @@
+#include "IncrementalParser.h"
+#include "Trace.h"
+#include "Parser.h"
+#include "TokenStream.h"
+#include <map>
+
+namespace {
+
+bool sameToken(const Token& a, const Token& b) {
+    return a.type == b.type && a.value == b.value;
+}
+
+void shiftLines(CSTNode* node, int delta) {
+    std::vector<CSTNode*> pending;
+    if (node) pending.push_back(node);
+    while (!pending.empty()) {
+        CSTNode* current = pending.back();
+        pending.pop_back();
+        if (current->lineNumber > 0) current->lineNumber += delta;
+        if (current->leftChild) pending.push_back(current->leftChild);
+        if (current->rightSibling) pending.push_back(current->rightSibling);
+    }
+}
+
+void shiftLines(SegmentResult& result, int delta) {
+    for (CSTNode* node : result.nodes) {
+        shiftLines(node, delta);
+    }
+    ErrorHandler shifted;
+    for (Diagnostic diagnostic : result.errors.getDiagnostics()) {
+        if (diagnostic.range.line > 0) {
+            diagnostic.range.line += delta;
+            diagnostic.range.endLine += delta;
+        }
+        shifted.add(diagnostic);
+    }
+    result.errors = shifted;
+}
+
+bool sameNames(const std::shared_ptr<const std::vector<std::string>>& a,
+               const std::shared_ptr<const std::vector<std::string>>& b) {
+    return a == b || (a && b && *a == *b);
+}
+
+} // namespace
+
+IncrementalParser::~IncrementalParser() {
+    releaseCache();
+}
+
+// top-level nodes are chained through rightSibling only while assembled into root
+void IncrementalParser::unlinkTopLevel() {
+    for (CachedSegment& segment : cache) {
+        for (CSTNode* node : segment.result->nodes) {
+            node->rightSibling = nullptr;
+        }
+    }
+    if (root) root->leftChild = nullptr;
+}
+
+void IncrementalParser::releaseCache() {
+    unlinkTopLevel();
+    for (CachedSegment& segment : cache) {
+        for (CSTNode* node : segment.result->nodes) {
+            deleteTree(node);
+        }
+    }
+    cache.clear();
+    delete root;
+    root = nullptr;
+}
+
+// whole-file parse, used when the file cannot be split into segments
+void IncrementalParser::fullReparse(const std::vector<Token>& tokens) {
+    TokenStream stream(tokens);
+    ErrorHandler parseErrors;
+    Parser parser(stream, parseErrors);
+    CSTNode* program = parser.parseProgram();
+
+    CachedSegment whole;
+    whole.range = {0, tokens.size(), false};
+    whole.result.reset(new SegmentResult());
+    for (CSTNode* node = program->leftChild; node; ) {
+        CSTNode* next = node->rightSibling;
+        node->rightSibling = nullptr;
+        whole.result->nodes.push_back(node);
+        node = next;
+    }
+    delete program;
+    whole.result->table = parser.getSymbolTable();
+    whole.result->errors = parseErrors;
+    whole.result->matchesSerial = true;
+
+    cache.push_back(std::move(whole));
+    cacheReusable = false;
+    reparsedSegments = 1;
+}
+
+CSTNode* IncrementalParser::update(const std::vector<Token>& tokens) {
+    TRACE_SCOPE("IncrementalParser::update");
+    unlinkTopLevel();
+
+    std::vector<TopLevelSegment> segments;
+    if (!findTopLevelSegments(tokens, 0, segments)) {
+        releaseCache();
+        fullReparse(tokens);
+        previousTokens = tokens;
+        assemble();
+        return root;
+    }
+
+    // tokens before `prefix` are identical (lines included); the last `suffix` tokens are
+    // identical up to one uniform line shift
+    size_t oldSize = previousTokens.size();
+    size_t newSize = tokens.size();
+    size_t prefix = 0;
+    while (prefix < oldSize && prefix < newSize &&
+           sameToken(previousTokens[prefix], tokens[prefix]) &&
+           previousTokens[prefix].lineNumber == tokens[prefix].lineNumber) {
+        prefix++;
+    }
+    size_t suffix = 0;
+    int lineDelta = 0;
+    if (oldSize > 0 && newSize > 0) {
+        lineDelta = tokens[newSize - 1].lineNumber - previousTokens[oldSize - 1].lineNumber;
+    }
+    while (suffix < oldSize - prefix && suffix < newSize - prefix &&
+           sameToken(previousTokens[oldSize - 1 - suffix], tokens[newSize - 1 - suffix]) &&
+           tokens[newSize - 1 - suffix].lineNumber - previousTokens[oldSize - 1 - suffix].lineNumber == lineDelta) {
+        suffix++;
+    }
+
+    std::map<std::pair<size_t, size_t>, size_t> oldByRange;
+    if (cacheReusable) {
+        for (size_t i = 0; i < cache.size(); ++i) {
+            oldByRange[{cache[i].range.begin, cache[i].range.end}] = i;
+        }
+    }
+    std::vector<CachedSegment> oldCache = std::move(cache);
+    cache.clear();
+
+    reparsedSegments = 0;
+    bool fallback = false;
+    SymbolTable globals;
+    auto globalNames = std::make_shared<const std::vector<std::string>>();
+
+    for (const TopLevelSegment& segment : segments) {
+        // an unchanged segment either lies in the common prefix or in the common suffix
+        CachedSegment* reusable = nullptr;
+        int shift = 0;
+        if (segment.end <= prefix) {
+            auto found = oldByRange.find({segment.begin, segment.end});
+            if (found != oldByRange.end()) reusable = &oldCache[found->second];
+        } else if (segment.begin >= newSize - suffix) {
+            size_t oldBegin = segment.begin - newSize + oldSize;
+            auto found = oldByRange.find({oldBegin, oldBegin + (segment.end - segment.begin)});
+            if (found != oldByRange.end()) reusable = &oldCache[found->second];
+            shift = lineDelta;
+        }
+        if (reusable && (!reusable->result || !sameNames(reusable->seedGlobals, globalNames))) {
+            reusable = nullptr;
+        }
+
+        CachedSegment entry;
+        entry.range = segment;
+        entry.seedGlobals = globalNames;
+        if (reusable) {
+            entry.result = std::move(reusable->result);
+            if (shift != 0) shiftLines(*entry.result, shift);
+        } else {
+            entry.result.reset(new SegmentResult());
+            Parser::parseSegment(tokens, segment, globals, *entry.result);
+            reparsedSegments++;
+            if (!entry.result->matchesSerial) fallback = true;
+        }
+
+        if (!segment.isDefinition && entry.result->table.getEntryCount() > entry.result->firstEntry) {
+            globals.append(entry.result->table, entry.result->firstEntry, 0);
+            auto names = std::make_shared<std::vector<std::string>>(*globalNames);
+            for (size_t i = entry.result->firstEntry; i < entry.result->table.getEntryCount(); ++i) {
+                names->push_back(entry.result->table.getEntry(i).identifierName);
+            }
+            globalNames = names;
+        }
+        cache.push_back(std::move(entry));
+        if (fallback) break;
+    }
+
+    // whatever was not reused is stale now
+    for (CachedSegment& old : oldCache) {
+        if (!old.result) continue;
+        for (CSTNode* node : old.result->nodes) deleteTree(node);
+    }
+
+    if (fallback) {
+        releaseCache();
+        fullReparse(tokens);
+    } else {
+        cacheReusable = true;
+    }
+
+    previousTokens = tokens;
+    assemble();
+    return root;
+}
+
+// chains the cached top-level nodes under a Program root and rebuilds the table and errors
+void IncrementalParser::assemble() {
+    if (!root) root = new CSTNode("Program");
+    root->leftChild = nullptr;
+    symbolTable = SymbolTable();
+    errors.clearErrors();
+
+    CSTNode* last = nullptr;
+    int scopeOffset = 0;
+    for (CachedSegment& segment : cache) {
+        for (CSTNode* node : segment.result->nodes) {
+            if (last) last->rightSibling = node;
+            else root->leftChild = node;
+            last = node;
+        }
+        symbolTable.append(segment.result->table, segment.result->firstEntry, scopeOffset);
+        scopeOffset += segment.result->table.getScopesUsed();
+        errors.appendErrors(segment.result->errors);
+    }
+}
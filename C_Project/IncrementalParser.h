@@ -0,0 +1,59 @@
+#ifndef INCREMENTAL_PARSER_H
+#define INCREMENTAL_PARSER_H
+
+#include "CSTNode.h"
+#include "ErrorHandler.h"
+#include "SymbolTable.h"
+#include "TopLevelSegments.h"
+#include "Tokenizer.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// keeps the CST, symbol table entries and errors of every top-level definition from
+// the previous parse, keyed by its token range. update() compares the new token list
+// with the previous one and only reparses the definitions (and global statement runs)
+// whose tokens changed; everything else is spliced back in, with line numbers shifted
+// when lines were added or removed above it. the result always equals a full
+// Parser::parseProgram of the new tokens.
+class IncrementalParser {
+public:
+    IncrementalParser() = default;
+    ~IncrementalParser();
+
+    IncrementalParser(const IncrementalParser&) = delete;
+    IncrementalParser& operator=(const IncrementalParser&) = delete;
+
+    // the returned tree is owned by this object and stays valid until the next update()
+    CSTNode* update(const std::vector<Token>& tokens);
+
+    const SymbolTable& getSymbolTable() const { return symbolTable; }
+    const ErrorHandler& getErrors() const { return errors; }
+    size_t getReparsedSegmentCount() const { return reparsedSegments; }
+    size_t getSegmentCount() const { return cache.size(); }
+
+private:
+    struct CachedSegment {
+        TopLevelSegment range;
+        std::unique_ptr<SegmentResult> result;
+        // names of the globals this segment was parsed against; its duplicate checks
+        // depend on nothing else outside its own tokens
+        std::shared_ptr<const std::vector<std::string>> seedGlobals;
+    };
+
+    void unlinkTopLevel();
+    void releaseCache();
+    void fullReparse(const std::vector<Token>& tokens);
+    void assemble();
+
+    std::vector<Token> previousTokens;
+    std::vector<CachedSegment> cache;
+    bool cacheReusable = false;  // false after a serial fallback parse
+
+    CSTNode* root = nullptr;
+    SymbolTable symbolTable;
+    ErrorHandler errors;
+    size_t reparsedSegments = 0;
+};
+
+#endif
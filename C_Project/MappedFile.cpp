@@ -0,0 +1,72 @@
+#include "MappedFile.h"
+#include <cstdio>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifdef HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length == 0) {  // mmap rejects empty files
+        ::close(fd);
+        bytes = fallback.data();
+        return true;
+    }
+    void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping keeps its own reference
+    if (address == MAP_FAILED) {
+        length = 0;
+        return false;
+    }
+    bytes = static_cast<const unsigned char*>(address);
+    mapped = true;
+    return true;
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    bytes = fallback.data();
+    length = fallback.size();
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifdef HAVE_MMAP
+    if (mapped) {
+        munmap(const_cast<unsigned char*>(bytes), length);
+    }
+#endif
+    bytes = nullptr;
+    length = 0;
+    mapped = false;
+    fallback.clear();
+}
+
+bool writeWholeFile(const std::string& path, const std::vector<char>& bytes) {
+    std::FILE* out = std::fopen(path.c_str(), "wb");
+    if (!out) return false;
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), out) == bytes.size();
+    ok = (std::fclose(out) == 0) && ok;
+    return ok;
+}
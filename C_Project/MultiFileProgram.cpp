@@ -0,0 +1,108 @@
+#include "MultiFileProgram.h"
+#include "Trace.h"
+#include "Parser.h"
+#include "ThreadPool.h"
+#include "TokenStream.h"
+#include <unordered_map>
+
+// used without a definition in the test programs
+static bool isBuiltinFunction(const std::string& name) {
+    return name == "printf";
+}
+
+// the file's scope-0 names come straight from the top level of its CST, which also
+// carries the line numbers the symbol table does not keep
+static void indexFile(ProgramFile& file, size_t fileIndex, GlobalIndex& index) {
+    for (const CSTNode* node = file.cst ? file.cst->leftChild : nullptr; node; node = node->rightSibling) {
+        if (node->name == "Procedure" || node->name == "Function") {
+            bool isFunction = node->name == "Function";
+            DataType returnType = TYPE_NONE;
+            if (isFunction && node->leftChild && node->leftChild->name == "ReturnType") {
+                returnType = dataTypeFromString(node->leftChild->value);
+            }
+            index.add({node->value, isFunction ? IDENTIFIER_FUNCTION : IDENTIFIER_PROCEDURE, returnType, fileIndex, node->lineNumber});
+        } else if (node->name == "Declaration") {
+            for (const CSTNode* variable = node->leftChild; variable; variable = variable->rightSibling) {
+                index.add({variable->value, IDENTIFIER_DATATYPE, dataTypeFromString(node->value), fileIndex, variable->lineNumber});
+            }
+        }
+    }
+
+    std::vector<const CSTNode*> pending;
+    if (file.cst) pending.push_back(file.cst);
+    while (!pending.empty()) {
+        const CSTNode* node = pending.back();
+        pending.pop_back();
+        if (node->name == "FunctionCall") file.calls.push_back({node->value, node->lineNumber});
+        if (node->rightSibling) pending.push_back(node->rightSibling);
+        if (node->leftChild) pending.push_back(node->leftChild);
+    }
+}
+
+void parseProgramFiles(std::vector<ProgramFile>& files, GlobalIndex& index, unsigned int threadCount) {
+    TRACE_SCOPE("parseProgramFiles");
+    ThreadPool pool(threadCount);
+    for (size_t i = 0; i < files.size(); ++i) {
+        pool.submit([&files, &index, i] {
+            ProgramFile& file = files[i];
+            TokenStream tokenStream(file.tokens);
+            Parser parser(tokenStream, file.errors);
+            file.cst = parser.parseProgram();
+            file.symbolTable = parser.getSymbolTable();
+            indexFile(file, i, index);
+        });
+    }
+    pool.wait();
+}
+
+void checkProgramFiles(std::vector<ProgramFile>& files, const GlobalIndex& index) {
+    TRACE_SCOPE("checkProgramFiles");
+    std::vector<GlobalDefinition> definitions = index.all();
+
+    // the first definition (file order) wins; every later one in another file is reported.
+    // same-file duplicates were already reported by that file's own symbol table
+    for (size_t begin = 0; begin < definitions.size();) {
+        size_t end = begin + 1;
+        while (end < definitions.size() && definitions[end].name == definitions[begin].name) end++;
+
+        const GlobalDefinition& winner = definitions[begin];
+        for (size_t i = begin + 1; i < end; ++i) {
+            const GlobalDefinition& later = definitions[i];
+            if (later.file == winner.file) continue;
+            files[later.file].errors.report(DIAG_DUPLICATE_ACROSS_FILES, later.line, later.name,
+                                            files[winner.file].name, winner.line);
+        }
+        begin = end;
+    }
+
+    std::unordered_map<std::string, bool> callable;  // name -> defined as a procedure/function
+    for (const GlobalDefinition& definition : definitions) {
+        bool isCallable = definition.kind == IDENTIFIER_FUNCTION || definition.kind == IDENTIFIER_PROCEDURE;
+        callable[definition.name] = callable[definition.name] || isCallable;
+    }
+    for (ProgramFile& file : files) {
+        for (const ProgramFile::Call& call : file.calls) {
+            auto found = callable.find(call.name);
+            if ((found == callable.end() || !found->second) && !isBuiltinFunction(call.name)) {
+                file.errors.report(DIAG_FUNCTION_NOT_IN_ANY_FILE, call.line, call.name);
+            }
+        }
+    }
+}
+
+void printGlobalIndex(const std::vector<ProgramFile>& files, const GlobalIndex& index, std::ostream& out) {
+    for (const GlobalDefinition& definition : index.all()) {
+        out << "IDENTIFIER_NAME: " << definition.name << "\n";
+        out << "IDENTIFIER_TYPE: " << identifierKindToString(definition.kind) << "\n";
+        out << "DATATYPE: " << dataTypeToString(definition.dataType) << "\n";
+        out << "FILE: " << files[definition.file].name << "\n";
+        out << "LINE: " << definition.line << "\n" << "\n";
+    }
+}
+
+void freeProgramFiles(std::vector<ProgramFile>& files) {
+    for (ProgramFile& file : files) {
+        deleteTree(file.cst);
+        file.cst = nullptr;
+    }
+}
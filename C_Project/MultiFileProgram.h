@@ -0,0 +1,38 @@
+#ifndef MULTI_FILE_PROGRAM_H
+#define MULTI_FILE_PROGRAM_H
+
+#include "CSTNode.h"
+#include "ErrorHandler.h"
+#include "GlobalIndex.h"
+#include "SymbolTable.h"
+#include "Tokenizer.h"
+#include <string>
+#include <vector>
+
+// one source file of a program whose procedures are spread over several files
+struct ProgramFile {
+    std::string name;
+    std::vector<Token> tokens;
+    ErrorHandler errors;      // this file's parse errors and cross-file findings
+    SymbolTable symbolTable;  // per-file table, as in single-file mode
+    CSTNode* cst = nullptr;   // owned; freed by freeProgramFiles
+
+    struct Call {
+        std::string name;
+        int line;
+    };
+    std::vector<Call> calls;  // every FunctionCall in the file, in source order
+};
+
+// parses every file on its own thread-pool task; each task adds its file's global
+// definitions to index as soon as the file is parsed. 0 threads = one per core
+void parseProgramFiles(std::vector<ProgramFile>& files, GlobalIndex& index, unsigned int threadCount = 0);
+
+// once every file is in the index: reports globals defined in more than one file and
+// calls that no file defines, each into the errors of the file where it occurs
+void checkProgramFiles(std::vector<ProgramFile>& files, const GlobalIndex& index);
+
+void printGlobalIndex(const std::vector<ProgramFile>& files, const GlobalIndex& index, std::ostream& out);
+void freeProgramFiles(std::vector<ProgramFile>& files);
+
+#endif
@@ -0,0 +1,143 @@
+#include "NameResolver.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cctype>
+
+// used without a declaration in the test programs
+static bool isBuiltinFunction(const std::string& name) {
+    return name == "printf";
+}
+
+static bool isBuiltinConstant(const std::string& name) {
+    return name == "TRUE" || name == "FALSE";
+}
+
+static bool isIdentifier(const std::string& text) {
+    return !text.empty() && (std::isalpha(static_cast<unsigned char>(text[0])) || text[0] == '_');
+}
+
+NameResolver::NameResolver(const SymbolTable& table, ErrorHandler& errors)
+    : table(table), errors(errors), resolvedUses(0) {
+    // procedures/functions first, each followed by its parameters, so parameters take
+    // the low slots of their scope before any local declared there
+    for (size_t i = 0; i < table.getEntryCount(); ++i) {
+        const SymbolTableEntry& entry = table.getEntry(i);
+        if (entry.identifierType != IDENTIFIER_PROCEDURE && entry.identifierType != IDENTIFIER_FUNCTION) continue;
+
+        functions.emplace(entry.identifierName, addSymbol(entry.identifierName, SYMBOL_FUNCTION, entry.scope, &entry));
+        if (const std::vector<SymbolTableEntry>* params = table.getParameterList(entry.identifierName)) {
+            for (const SymbolTableEntry& param : *params) {
+                addSymbol(param.identifierName, SYMBOL_PARAMETER, entry.scope, &param);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < table.getEntryCount(); ++i) {
+        const SymbolTableEntry& entry = table.getEntry(i);
+        if (entry.identifierType != IDENTIFIER_DATATYPE) continue;
+        addSymbol(entry.identifierName, entry.scope == 0 ? SYMBOL_GLOBAL : SYMBOL_LOCAL, entry.scope, &entry);
+    }
+}
+
+int NameResolver::addSymbol(const std::string& name, SymbolKind kind, int scope, const SymbolTableEntry* entry) {
+    int id = static_cast<int>(symbols.size());
+    ResolvedSymbol symbol{name, kind, scope, -1, -1, entry};
+
+    if (kind != SYMBOL_FUNCTION) {
+        symbol.scopeDepth = depthOf(scope);
+        symbol.slotIndex = slotCounts[scope]++;
+        scopes[scope].emplace(name, id);
+    }
+    symbols.push_back(symbol);
+    return id;
+}
+
+int NameResolver::depthOf(int scope) const {
+    int depth = 0;
+    while (scope != 0) {
+        scope = table.getParentScope(scope);
+        depth++;
+    }
+    return depth;
+}
+
+int NameResolver::getSlotCount(int scope) const {
+    auto found = slotCounts.find(scope);
+    return found == slotCounts.end() ? 0 : found->second;
+}
+
+int NameResolver::findFunction(const std::string& name) const {
+    auto found = functions.find(name);
+    return found == functions.end() ? -1 : found->second;
+}
+
+int NameResolver::findVariable(const std::string& name, int scope) const {
+    while (true) {
+        auto names = scopes.find(scope);
+        if (names != scopes.end()) {
+            auto found = names->second.find(name);
+            if (found != names->second.end()) return found->second;
+        }
+        if (scope == 0) return -1;
+        scope = table.getParentScope(scope);
+    }
+}
+
+void NameResolver::resolveUse(CSTNode* node, int scope) {
+    const std::string& name = node->value;
+    int id = -1;
+    // a tree kept by IncrementalParser may carry the binding of an earlier resolve
+    node->symbolId = -1;
+    node->scopeDepth = -1;
+    node->slotIndex = -1;
+
+    if (node->name == "FunctionCall") {
+        auto found = functions.find(name);
+        if (found != functions.end()) {
+            id = found->second;
+        } else if (!isBuiltinFunction(name)) {
+            errors.report(DIAG_UNDEFINED_FUNCTION, node->lineNumber, name);
+        }
+    } else {
+        id = findVariable(name, scope);
+        if (id < 0) errors.report(DIAG_UNDEFINED_VARIABLE, node->lineNumber, name);
+    }
+
+    if (id < 0) return;
+    node->symbolId = id;
+    node->scopeDepth = symbols[id].scopeDepth;
+    node->slotIndex = symbols[id].slotIndex;
+    resolvedUses++;
+}
+
+void NameResolver::resolve(CSTNode* root) {
+    TRACE_SCOPE("NameResolver::resolve");
+    std::vector<std::pair<CSTNode*, int>> pending;  // node and the scope it sits in
+    for (CSTNode* node = root; node; node = node->rightSibling) pending.push_back({node, 0});
+
+    // reversed on the way in so uses are visited (and reported) in source order
+    std::reverse(pending.begin(), pending.end());
+
+    while (!pending.empty()) {
+        CSTNode* node = pending.back().first;
+        int scope = pending.back().second;
+        pending.pop_back();
+
+        if (node->name == "Declaration" || node->name == "ParameterType") {
+            continue;  // declares names, uses none (array sizes are literals)
+        }
+
+        if (node->name == "Procedure" || node->name == "Function") {
+            auto found = functions.find(node->value);
+            if (found != functions.end()) scope = symbols[found->second].scope;
+        } else if (node->name == "FunctionCall" || node->name == "ArrayAccess" ||
+                   (node->name == "Assignment" && node->value != "[]") ||
+                   (node->name == "Operand" && isIdentifier(node->value) && !isBuiltinConstant(node->value))) {
+            resolveUse(node, scope);
+        }
+
+        size_t firstChild = pending.size();
+        for (CSTNode* child = node->leftChild; child; child = child->rightSibling) pending.push_back({child, scope});
+        std::reverse(pending.begin() + firstChild, pending.end());
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef NAME_RESOLVER_H
+#define NAME_RESOLVER_H
+
+#include "CSTNode.h"
+#include "ErrorHandler.h"
+#include "SymbolTable.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum SymbolKind {
+    SYMBOL_GLOBAL,
+    SYMBOL_LOCAL,
+    SYMBOL_PARAMETER,
+    SYMBOL_FUNCTION  // procedures too
+};
+
+// one declared name. variables live in a frame slot: scopeDepth counts scopes out from
+// the globals (0) and slotIndex is the position within that scope, parameters first in
+// parameter-list order, then locals in declaration order. functions have no slot (-1)
+struct ResolvedSymbol {
+    std::string name;
+    SymbolKind kind;
+    int scope;       // symbol table scope id
+    int scopeDepth;
+    int slotIndex;
+    const SymbolTableEntry* entry;  // points into the SymbolTable the resolver was built from
+};
+
+// binds every identifier use in the CST (Operand, Assignment, ArrayAccess and
+// FunctionCall nodes) to a ResolvedSymbol: the node's symbolId indexes getSymbols()
+// and scopeDepth/slotIndex are copied from it. names that resolve to nothing are
+// reported to errors. the table must be the one built while parsing the tree and must
+// outlive the resolver
+class NameResolver {
+public:
+    NameResolver(const SymbolTable& table, ErrorHandler& errors);
+
+    void resolve(CSTNode* root);  // root and its right siblings
+
+    const std::vector<ResolvedSymbol>& getSymbols() const { return symbols; }
+    int getSlotCount(int scope) const;
+    int findFunction(const std::string& name) const;  // symbol id, -1 if not declared
+    size_t getResolvedUseCount() const { return resolvedUses; }
+
+private:
+    int addSymbol(const std::string& name, SymbolKind kind, int scope, const SymbolTableEntry* entry);
+    int depthOf(int scope) const;
+    int findVariable(const std::string& name, int scope) const;
+    void resolveUse(CSTNode* node, int scope);
+
+    const SymbolTable& table;
+    ErrorHandler& errors;
+    std::vector<ResolvedSymbol> symbols;
+    std::unordered_map<std::string, int> functions;                      // name -> symbol id
+    std::unordered_map<int, std::unordered_map<std::string, int>> scopes;  // scope -> name -> symbol id
+    std::unordered_map<int, int> slotCounts;
+    size_t resolvedUses;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "Parser.h"
+#include "Trace.h"
 #include "CSTNode.h"
 #include "TokenStream.h"
 #include "ErrorHandler.h"
@@ -6,56 +7,174 @@
 #include "SymbolTable.h"
 
 Parser::Parser(TokenStream& tokenStream, ErrorHandler& errorHandler)
-    : tokenStream(tokenStream), errorHandler(errorHandler) {}
+    : tokenStream(tokenStream), errorHandler(errorHandler), listener(nullptr) {}
+
+Parser::Parser(TokenStream& tokenStream, ErrorHandler& errorHandler, const SymbolTable& initialTable)
+    : tokenStream(tokenStream), errorHandler(errorHandler), symbolTable(initialTable), listener(nullptr) {}
+
+// in streaming mode a container node (program, procedure, if/else, while, for) is
+// announced with enterNode as soon as it is created, its children are streamed and
+// freed as they get attached, and exitNode is sent when its parse function returns --
+// on success or on any error path. without a listener this does nothing
+class Parser::StreamScope {
+public:
+    StreamScope(Parser& parser, CSTNode* node) : listener(parser.listener) {
+        if (listener) {
+            listener->enterNode(*node);
+            node->streamed = true;
+        }
+    }
+    ~StreamScope() { close(); }
+
+    void close() {
+        if (listener) listener->exitNode();
+        listener = nullptr;
+    }
 
-void Parser::reportError(const std::string& message, int lineNumber) {
-    errorHandler.addError(lineNumber, message);
+private:
+    CSTListener* listener;
+};
+
+// adds child under a container node. when streaming, the finished child is written
+// out (unless it is a container that already streamed itself) and freed right away
+void Parser::attach(CSTNode* parent, CSTNode* child) {
+    if (!listener) {
+        parent->addChild(child);
+        return;
+    }
+    if (!child->streamed) {
+        emitCST(child, *listener);
+    }
+    deleteTree(child);
 }
 
 CSTNode* Parser::parseProgram() {
+    TRACE_SCOPE("Parser::parseProgram");
     CSTNode* root = new CSTNode("Program");
+    StreamScope rootScope(*this, root);
 
     while (tokenStream.hasMoreTokens()) {
-        Token token = tokenStream.getNextToken();
+        CSTNode* item = parseTopLevelItem();
+        if (item) {
+            attach(root, item);
+        }
+    }
+    return root;  // partial tree if errors were recorded, the caller checks the error handler
+}
+
+// one procedure/function definition or top-level statement. returns nullptr when
+// the item had a syntax error; the error is recorded and the stream resynchronized
+CSTNode* Parser::parseTopLevelItem() {
+    int start = tokenStream.getCurrentIndex();
+    Token token = tokenStream.getNextToken();
+    
+    if (token.type == TOKEN_PROCEDURE || token.value == "function") { 
+        bool isFunction = (token.value == "function");
+
+        // if it's a function, grab the return type
+        std::string typeName = "Procedure";  // default type
+        Token returnTypeToken;
+        if (isFunction) {
+            typeName = "Function";
         
-        if (token.type == TOKEN_PROCEDURE || token.value == "function") { 
-            bool isFunction = (token.value == "function");
-
-            // if it's a function, grab the return type
-            std::string typeName = "Procedure";  // default type
-            Token returnTypeToken;
-            if (isFunction) {
-                typeName = "Function";
-            
-                returnTypeToken = tokenStream.getNextToken();
-                if (returnTypeToken.type != TOKEN_TYPE) {
-                    reportError("Expected return type after 'function'.", returnTypeToken.lineNumber);
-                    delete root;
-                    return nullptr;
-                }
+            returnTypeToken = tokenStream.getNextToken();
+            if (returnTypeToken.type != TOKEN_TYPE) {
+                reportError(DIAG_EXPECTED_RETURN_TYPE, returnTypeToken.lineNumber);
+                synchronize(start);
+                return nullptr;
             }
+        }
+
+        // parse the procedure or function declaration
+        CSTNode* procedureNode = parseProcedure(typeName, returnTypeToken);
+        if (!procedureNode) {
+            synchronize(start);  // skip the rest of the broken definition
+        }
+        return procedureNode;
+    } 
+
+    tokenStream.rewind();  // put the token back for parseStatement to process it.
+    CSTNode* statementNode = parseStatement();
+    
+    if (!statementNode) {
+        reportError(DIAG_EXPECTED_STATEMENT_AT_START, token.lineNumber);
+        synchronize(start);
+    }
+    return statementNode;
+}
+
+// panic-mode recovery: after a syntax error has been recorded, skip ahead to the next
+// synchronization point so the rest of the file still gets parsed and reported.
+// we stop after a ';' or after a '}' that closes a block opened while skipping, and
+// before a '}' that closes the enclosing block or the next 'procedure'/'function'.
+void Parser::synchronize(int failedAt) {
+    if (!tokenStream.hasMoreTokens() && tokenStream.getCurrentIndex() <= failedAt) {
+        return;
+    }
 
-            // parse the procedure or function declaration
-            CSTNode* procedureNode = parseProcedure(typeName, returnTypeToken);
-            if (procedureNode) {
-                root->addChild(procedureNode);
+    int depth = 0;  // braces opened while skipping
+
+    // the failed construct may already have consumed the token we would stop at
+    if (tokenStream.getCurrentIndex() > failedAt) {
+        tokenStream.rewind();
+        Token last = tokenStream.getNextToken();
+        if (last.type == TOKEN_L_BRACE) {
+            depth = 1;  // failed right on a block opener, skip that whole block
+        }
+        if (last.type == TOKEN_SEMICOLON) {
+            return;
+        }
+        if (last.type == TOKEN_R_BRACE || isDefinitionStart(last)) {
+            tokenStream.rewind();  // leave it for the enclosing block / program loop
+            if (tokenStream.getCurrentIndex() > failedAt) {
+                return;
             }
-        } 
-        else {
-            tokenStream.rewind();  // put the token back for parseStatement to process it.
-            CSTNode* statementNode = parseStatement();
-            
-            if (statementNode) {
-                root->addChild(statementNode);  // add to the root node
-            } 
-            else {
-                reportError("Expected valid statement at start of program.", token.lineNumber);
-                delete root;
-                return nullptr;
+            tokenStream.getNextToken();  // the construct failed on this very token, make progress
+        }
+    }
+    else {
+        tokenStream.getNextToken();  // nothing was consumed, make progress
+    }
+
+    while (tokenStream.hasMoreTokens()) {
+        Token token = tokenStream.peekNextToken();
+
+        if (isDefinitionStart(token)) {
+            return;
+        }
+        if (token.type == TOKEN_L_BRACE) {
+            depth++;
+        }
+        else if (token.type == TOKEN_R_BRACE) {
+            if (depth == 0) {
+                return;  // closes the enclosing block
             }
+            if (--depth == 0) {
+                tokenStream.getNextToken();  // skipped block is complete
+                return;
+            }
+        }
+        else if (token.type == TOKEN_SEMICOLON && depth == 0) {
+            tokenStream.getNextToken();
+            return;
         }
+        tokenStream.getNextToken();
     }
-    return root;
+}
+
+bool Parser::isDefinitionStart(const Token& token) const {
+    return token.type == TOKEN_PROCEDURE || token.type == TOKEN_FUNCTION;
+}
+
+// parse one statement of a block; on failure the error is already recorded, so
+// resynchronize and let the block loop carry on with the next statement
+CSTNode* Parser::parseStatementOrRecover() {
+    int start = tokenStream.getCurrentIndex();
+    CSTNode* statementNode = parseStatement();
+    if (!statementNode) {
+        synchronize(start);
+    }
+    return statementNode;
 }
 
 
@@ -64,11 +183,11 @@ CSTNode* Parser::parseProcedure(const std::string& nodeType, const Token& return
 
     if (token.type != TOKEN_IDENTIFIER) {
         if (keywords.find(token.value) != keywords.end()) {
-            reportError("Syntax error: cannot define a function with reserved word '" + token.value + "'", token.lineNumber);
+            reportError(DIAG_RESERVED_FUNCTION_NAME, token.lineNumber, token.value);
             return nullptr;
         }
         else{
-            reportError("Expected procedure or function name.", token.lineNumber);
+            reportError(DIAG_EXPECTED_DEFINITION_NAME, token.lineNumber);
             return nullptr;
         }
     }
@@ -80,151 +199,163 @@ CSTNode* Parser::parseProcedure(const std::string& nodeType, const Token& return
     
     // create a node for the procedure itself
     CSTNode* procedureNode = new CSTNode(nodeType, token.value, token.lineNumber);
+    StreamScope procedureScope(*this, procedureNode);
     SymbolTableEntry procEntry;
     procEntry.identifierName = token.value;
-    procEntry.identifierType = (nodeType == "Function") ? "function" : "procedure";
-    procEntry.dataType = (nodeType == "Function") ? returnTypeToken.value : "NOT APPLICABLE";
+    procEntry.identifierType = (nodeType == "Function") ? IDENTIFIER_FUNCTION : IDENTIFIER_PROCEDURE;
+    procEntry.dataType = (nodeType == "Function") ? dataTypeFromString(returnTypeToken.value) : TYPE_NONE;
     procEntry.isArray = false;
     procEntry.arraySize = 0;
     procEntry.scope = currentScope;
-    try {
-        symbolTable.addEntry(procEntry);      
-    }
-    catch (const std::runtime_error& e) {
-        reportError(e.what(), token.lineNumber);
+    DeclareResult declared = symbolTable.tryAddEntry(procEntry);
+    if (declared != DECLARE_OK) {
+        reportError(SymbolTable::conflictDiagnostic(declared), token.lineNumber, procEntry.identifierName);
+        symbolTable.exitScope();  // keep the scope stack balanced for recovery
+        delete procedureNode;
         return nullptr;                   
     }
     
     if (nodeType == "Function" && returnTypeToken.type != TOKEN_UNKNOWN) {
-        procedureNode->addChild(new CSTNode("ReturnType", returnTypeToken.value, returnTypeToken.lineNumber));
+        attach(procedureNode, new CSTNode("ReturnType", returnTypeToken.value, returnTypeToken.lineNumber));
     }
     
     // parse the opening parenthesis '('
     token = tokenStream.getNextToken();
     if (token.type != TOKEN_L_PAREN) {
-        reportError("Expected '(' after procedure or function name.", token.lineNumber);
+        reportError(DIAG_EXPECTED_PARAMETER_LIST, token.lineNumber);
+        symbolTable.exitScope();
         delete procedureNode;
         return nullptr;
     }
-    procedureNode->addChild(new CSTNode("Symbol", "(", token.lineNumber));  // add '(' to CST
+    attach(procedureNode, new CSTNode("Symbol", "(", token.lineNumber));  // add '(' to CST
 
     // parse the parameter list (if any)
     while (tokenStream.hasMoreTokens()) {
         token = tokenStream.getNextToken();
         
         if (token.type == TOKEN_R_PAREN) {  // end of parameter list
-            procedureNode->addChild(new CSTNode("Symbol", ")", token.lineNumber));  // add ')' to CST
+            attach(procedureNode, new CSTNode("Symbol", ")", token.lineNumber));  // add ')' to CST
             break;
         }
 
-        if (token.type == TOKEN_TYPE) {
-            if (token.value == "void") {
-                // accept 'void' as the only parameter, followed immediately by ')'
-                procedureNode->addChild(new CSTNode("ParameterType", "void", token.lineNumber));
-        
-                token = tokenStream.getNextToken();
-                if (token.type != TOKEN_R_PAREN) {
-                    reportError("Expected ')' after 'void'.", token.lineNumber);
-                    delete procedureNode;
-                    return nullptr;
-                }
-        
-                procedureNode->addChild(new CSTNode("Symbol", ")", token.lineNumber));
-                
-                break;  // end parsing parameter list
-                
-            }
-        
-            CSTNode* paramTypeNode = new CSTNode("ParameterType", token.value, token.lineNumber);
+        if (token.type != TOKEN_TYPE) {  // without this a missing ')' swallows the rest of the file
+            reportError(DIAG_EXPECTED_PARAMETER_TYPE, token.lineNumber);
+            symbolTable.exitScope();
+            delete procedureNode;
+            return nullptr;
+        }
+
+        if (token.value == "void") {
+            // accept 'void' as the only parameter, followed immediately by ')'
+            attach(procedureNode, new CSTNode("ParameterType", "void", token.lineNumber));
+    
             token = tokenStream.getNextToken();
-        
-            if (token.type == TOKEN_IDENTIFIER) {          // ← outer test already true
-                bool isArrayParam = false;
-                int  arraySize    = 0;
-            
-                /* look for “[ size ]” */
-                Token afterName = tokenStream.peekNextToken();
-                if (afterName.type == TOKEN_L_BRACKET) {
-                    tokenStream.getNextToken();                 // consume '['
-                    Token sizeTok = tokenStream.getNextToken(); // expect integer
-                    if (sizeTok.type != TOKEN_INTEGER) {
-                        reportError("Expected integer size for array parameter.", sizeTok.lineNumber);
-                        delete procedureNode;
-                        return nullptr;
-                    }
-                    isArrayParam = true;
-                    arraySize    = std::stoi(sizeTok.value);
-            
-                    Token closeBr = tokenStream.getNextToken(); // expect ']'
-                    if (closeBr.type != TOKEN_R_BRACKET) {
-                        reportError("Expected ']' after array size.", closeBr.lineNumber);
-                        delete procedureNode;
-                        return nullptr;
-                    }
-                }
-            
-                /* build CST */
-                CSTNode* paramNode = new CSTNode("Parameter", token.value, token.lineNumber);
-                if (isArrayParam) {
-                    paramNode->addChild(new CSTNode("ArraySize", std::to_string(arraySize), token.lineNumber)); // optional
-                }
-                paramTypeNode->addChild(paramNode);
-                procedureNode->addChild(paramTypeNode);
+            if (token.type != TOKEN_R_PAREN) {
+                reportError(DIAG_EXPECTED_CLOSE_AFTER_VOID, token.lineNumber);
+                symbolTable.exitScope();
+                delete procedureNode;
+                return nullptr;
+            }
+    
+            attach(procedureNode, new CSTNode("Symbol", ")", token.lineNumber));
             
-                // symbol‑table entry – store only in parameter list 
-                SymbolTableEntry paramEntry;
-                paramEntry.identifierName = token.value;
-                paramEntry.identifierType = "parameter";
-                paramEntry.dataType       = paramTypeNode->value;
-                paramEntry.isArray        = isArrayParam;
-                paramEntry.arraySize      = arraySize;
-                paramEntry.scope          = currentScope;
+            break;  // end parsing parameter list
             
-                symbolTable.addFunctionParameter(procEntry.identifierName, paramEntry);
-            }
-            else {
-                if (keywords.find(token.value) != keywords.end()) {
-                    reportError("Syntax error: reserved word '" + token.value +
-                                "' cannot be used as a parameter name.", token.lineNumber);
+        }
+    
+        CSTNode* paramTypeNode = new CSTNode("ParameterType", token.value, token.lineNumber);
+        token = tokenStream.getNextToken();
+    
+        if (token.type == TOKEN_IDENTIFIER) {
+            bool isArrayParam = false;
+            int  arraySize    = 0;
+        
+            /* look for “[ size ]” */
+            Token afterName = tokenStream.peekNextToken();
+            if (afterName.type == TOKEN_L_BRACKET) {
+                tokenStream.getNextToken();                 // consume '['
+                Token sizeTok = tokenStream.getNextToken(); // expect integer
+                if (sizeTok.type != TOKEN_INTEGER) {
+                    reportError(DIAG_EXPECTED_PARAMETER_ARRAY_SIZE, sizeTok.lineNumber);
+                    symbolTable.exitScope();
                     delete procedureNode;
                     return nullptr;
-                } else {
-                    reportError("Expected parameter name after type.", token.lineNumber);
+                }
+                isArrayParam = true;
+                arraySize    = std::stoi(sizeTok.value);
+        
+                Token closeBr = tokenStream.getNextToken(); // expect ']'
+                if (closeBr.type != TOKEN_R_BRACKET) {
+                    reportError(DIAG_EXPECTED_CLOSE_ARRAY_SIZE, closeBr.lineNumber);
+                    symbolTable.exitScope();
                     delete procedureNode;
                     return nullptr;
                 }
             }
+        
+            /* build CST */
+            CSTNode* paramNode = new CSTNode("Parameter", token.value, token.lineNumber);
+            if (isArrayParam) {
+                paramNode->addChild(new CSTNode("ArraySize", std::to_string(arraySize), token.lineNumber)); // optional
+            }
+            paramTypeNode->addChild(paramNode);
+            attach(procedureNode, paramTypeNode);
+        
+            // symbol‑table entry – store only in parameter list 
+            SymbolTableEntry paramEntry;
+            paramEntry.identifierName = token.value;
+            paramEntry.identifierType = IDENTIFIER_PARAMETER;
+            paramEntry.dataType       = dataTypeFromString(paramTypeNode->value);
+            paramEntry.isArray        = isArrayParam;
+            paramEntry.arraySize      = arraySize;
+            paramEntry.scope          = currentScope;
+        
+            symbolTable.addFunctionParameter(procEntry.identifierName, paramEntry);
+        }
+        else {
+            if (keywords.find(token.value) != keywords.end()) {
+                reportError(DIAG_RESERVED_PARAMETER_NAME, token.lineNumber, token.value);
+                symbolTable.exitScope();
+                delete procedureNode;
+                return nullptr;
+            } else {
+                reportError(DIAG_EXPECTED_PARAMETER_NAME, token.lineNumber);
+                symbolTable.exitScope();
+                delete procedureNode;
+                return nullptr;
+            }
         }
 
         Token lookAhead = tokenStream.peekNextToken();      // NEW
         if (lookAhead.type == TOKEN_COMMA) {                // use lookAhead
             tokenStream.getNextToken();                     // consume the comma
-            procedureNode->addChild(new CSTNode("Symbol", ",", lookAhead.lineNumber));
+            attach(procedureNode, new CSTNode("Symbol", ",", lookAhead.lineNumber));
         }
     }
 
     // parse the opening brace '{'
     token = tokenStream.getNextToken();
     if (token.type != TOKEN_L_BRACE) {
-        reportError("Expected '{' at the start of procedure or function body.", token.lineNumber);
+        reportError(DIAG_EXPECTED_BODY, token.lineNumber);
+        symbolTable.exitScope();
         delete procedureNode;
         return nullptr;
     }
-    procedureNode->addChild(new CSTNode("Symbol", "{", token.lineNumber));  // add '{' to CST
+    attach(procedureNode, new CSTNode("Symbol", "{", token.lineNumber));  // add '{' to CST
 
     // parse the procedure body (statements)
     while (tokenStream.hasMoreTokens()) {
         token = tokenStream.getNextToken();
         if (token.type == TOKEN_R_BRACE) {  // end of procedure body
-            procedureNode->addChild(new CSTNode("Symbol", "}", token.lineNumber));  // add '}' to CST
+            attach(procedureNode, new CSTNode("Symbol", "}", token.lineNumber));  // add '}' to CST
             break;
         }
 
         tokenStream.rewind();
-        CSTNode* statementNode = parseStatement();
+        CSTNode* statementNode = parseStatementOrRecover();
 
         if (statementNode) {
-            procedureNode->addChild(statementNode);
+            attach(procedureNode, statementNode);
         }
     }
     symbolTable.exitScope();
@@ -237,10 +368,11 @@ CSTNode* Parser::parseStatement() {
 
     if (token.type == TOKEN_KEYWORD && token.value == "for") {  // handling "for" loops        
         CSTNode* forNode = new CSTNode("ForStatement", "for", token.lineNumber);
+        StreamScope forScope(*this, forNode);
     
         token = tokenStream.getNextToken();
         if (token.type != TOKEN_L_PAREN) {
-            reportError("Expected '(' after 'for'.", token.lineNumber);
+            reportError(DIAG_EXPECTED_FOR_OPEN, token.lineNumber);
             delete forNode;
             return nullptr;
         }
@@ -251,7 +383,7 @@ CSTNode* Parser::parseStatement() {
             delete forNode;
             return nullptr;
         }
-        forNode->addChild(initNode);
+        attach(forNode, initNode);
     
         // parse Condition (e.g., (i < 4) && (digit > -1))
         CSTNode* conditionNode = parseExpression();
@@ -259,12 +391,14 @@ CSTNode* Parser::parseStatement() {
             delete forNode;
             return nullptr;
         }
-        forNode->addChild(conditionNode);
+        attach(forNode, conditionNode);
     
         token = tokenStream.getNextToken();
         if (token.type != TOKEN_SEMICOLON) {  
+#ifdef DEBUG
             std::cout << "Unexpected token: " << token.value << " on Line: " << token.lineNumber << std::endl;
-            reportError("Expected ';' after 'for' loop condition.", token.lineNumber);
+#endif
+            reportError(DIAG_EXPECTED_FOR_SEMICOLON, token.lineNumber);
             delete forNode;
             return nullptr;
         } 
@@ -278,8 +412,10 @@ CSTNode* Parser::parseStatement() {
             CSTNode* incrementNode = new CSTNode("Increment", idToken.value, idToken.lineNumber);
             incrementNode->addChild(new CSTNode("Operator", nextToken.value, nextToken.lineNumber));
 
-            forNode->addChild(incrementNode);
+            attach(forNode, incrementNode);
+#ifdef DEBUG
             std::cout << "Successfully parsed increment or decrement operator in for loop.\n";
+#endif
         } 
         // handle assignment expressions like "i = i + 1"
         else if (idToken.type == TOKEN_IDENTIFIER && nextToken.type == TOKEN_ASSIGNMENT_OPERATOR) {
@@ -294,18 +430,22 @@ CSTNode* Parser::parseStatement() {
             }
             incrementNode->addChild(expr);
 
-            forNode->addChild(incrementNode);
+            attach(forNode, incrementNode);
         } else {
+#ifdef DEBUG
             std::cout << "Failed to parse the increment section of the 'for' loop.\n";
-            reportError("Expected increment expression (i++, i--, or assignment) in 'for' loop increment.", idToken.lineNumber);
+#endif
+            reportError(DIAG_EXPECTED_FOR_INCREMENT, idToken.lineNumber);
             delete forNode;
             return nullptr;
         }
 
         token = tokenStream.getNextToken();
         if (token.type != TOKEN_R_PAREN) {
+#ifdef DEBUG
             std::cout << "Expected ')'. Found: " << token.value << " on Line: " << token.lineNumber << std::endl;
-            reportError("Expected ')' after 'for' loop header.", token.lineNumber);
+#endif
+            reportError(DIAG_EXPECTED_FOR_CLOSE, token.lineNumber);
             delete forNode;
             return nullptr;
         }
@@ -313,7 +453,7 @@ CSTNode* Parser::parseStatement() {
         // expect the opening brace for the 'for' loop body
         token = tokenStream.getNextToken();
         if (token.type != TOKEN_L_BRACE) {
-            reportError("Expected '{' after 'for' loop header.", token.lineNumber);
+            reportError(DIAG_EXPECTED_FOR_BODY, token.lineNumber);
             delete forNode;
             return nullptr;
         }
@@ -324,10 +464,10 @@ CSTNode* Parser::parseStatement() {
             if (token.type == TOKEN_R_BRACE) break;
 
             tokenStream.rewind();
-            CSTNode* statementNode = parseStatement();
+            CSTNode* statementNode = parseStatementOrRecover();
 
             if (statementNode) {
-                forNode->addChild(statementNode);
+                attach(forNode, statementNode);
             }
         }
         return forNode;
@@ -349,7 +489,7 @@ CSTNode* Parser::parseStatement() {
                 if (nextToken.type == TOKEN_L_BRACKET) {  // detects '[' for arrays
                     // Error if identifier name is a reserved type (e.g., "char char;")
                     if (keywords.find(token.value) != keywords.end()) {
-                        reportError("Syntax error: reserved word '" + token.value + "' cannot be used as a variable name.", token.lineNumber);
+                        reportError(DIAG_RESERVED_VARIABLE_NAME, token.lineNumber, token.value);
                         delete declarationNode;
                         return nullptr;
                     }
@@ -364,7 +504,7 @@ CSTNode* Parser::parseStatement() {
                         tokenStream.getNextToken();  // consume '+' or '-'
                         numberToken = tokenStream.getNextToken();
                         if (numberToken.type != TOKEN_INTEGER) {
-                            reportError("Expected integer after '+' or '-' in array size.", numberToken.lineNumber);
+                            reportError(DIAG_EXPECTED_SIGNED_ARRAY_SIZE, numberToken.lineNumber);
                             delete declarationNode;
                             return nullptr;
                         }
@@ -372,7 +512,7 @@ CSTNode* Parser::parseStatement() {
                     } else {
                         numberToken = tokenStream.getNextToken();
                         if (numberToken.type != TOKEN_INTEGER) {
-                            reportError("Expected integer size for array declaration.", numberToken.lineNumber);
+                            reportError(DIAG_EXPECTED_ARRAY_SIZE, numberToken.lineNumber);
                             delete declarationNode;
                             return nullptr;
                         }
@@ -382,12 +522,12 @@ CSTNode* Parser::parseStatement() {
                     try {
                         int size = std::stoi(sizeValue);
                         if (size <= 0) {
-                            reportError("Syntax error: array declaration size must be a positive integer.", numberToken.lineNumber);
+                            reportError(DIAG_ARRAY_SIZE_NOT_POSITIVE, numberToken.lineNumber);
                             delete declarationNode;
                             return nullptr;
                         }
                     } catch (...) {
-                        reportError("Syntax error: array declaration size must be a positive integer.", numberToken.lineNumber);
+                        reportError(DIAG_ARRAY_SIZE_NOT_POSITIVE, numberToken.lineNumber);
                         delete declarationNode;
                         return nullptr;
                     }
@@ -398,7 +538,7 @@ CSTNode* Parser::parseStatement() {
                     // now expect a closing bracket ']'
                     nextToken = tokenStream.getNextToken();
                     if (nextToken.type != TOKEN_R_BRACKET) {
-                        reportError("Expected ']' after array size.", nextToken.lineNumber);
+                        reportError(DIAG_EXPECTED_CLOSE_ARRAY_SIZE, nextToken.lineNumber);
                         delete declarationNode;
                         return nullptr;
                     }
@@ -411,28 +551,27 @@ CSTNode* Parser::parseStatement() {
 
                 SymbolTableEntry varEntry;                // add to symbol table
                 varEntry.identifierName = token.value;
-                varEntry.identifierType = "datatype";
-                varEntry.dataType = declarationNode->value;
+                varEntry.identifierType = IDENTIFIER_DATATYPE;
+                varEntry.dataType = dataTypeFromString(declarationNode->value);
                 varEntry.isArray = (variableNode->name == "ArrayDeclaration");
                 varEntry.arraySize = (varEntry.isArray && variableNode->leftChild) ? std::stoi(variableNode->leftChild->value) : 0;
                 varEntry.scope = symbolTable.getCurrentScopeLevel();
-                try {
-                    symbolTable.addEntry(varEntry);    
-                }
-                catch (const std::runtime_error& e) {
-                    reportError(e.what(), token.lineNumber);  
+                DeclareResult declared = symbolTable.tryAddEntry(varEntry);
+                if (declared != DECLARE_OK) {
+                    reportError(SymbolTable::conflictDiagnostic(declared), token.lineNumber, varEntry.identifierName);
+                    delete declarationNode;
                     return nullptr;                         
                 }
                 
             } 
             else {
                 if (keywords.find(token.value) != keywords.end()) {
-                    reportError("Syntax error: reserved word '" + token.value + "' cannot be used as a variable name.", token.lineNumber);
+                    reportError(DIAG_RESERVED_VARIABLE_NAME, token.lineNumber, token.value);
                     delete declarationNode;
                     return nullptr;
                 }
                 else{
-                    reportError("Expected variable name after type.", token.lineNumber);
+                    reportError(DIAG_EXPECTED_VARIABLE_NAME, token.lineNumber);
                     delete declarationNode;
                     return nullptr;
                 }
@@ -449,7 +588,7 @@ CSTNode* Parser::parseStatement() {
                 break;
             } 
             else {  // unexpected token
-                reportError("Expected ';' after variable declaration.", token.lineNumber);
+                reportError(DIAG_EXPECTED_DECLARATION_SEMICOLON, token.lineNumber);
                 delete declarationNode;
                 return nullptr;
             }
@@ -471,14 +610,14 @@ CSTNode* Parser::parseStatement() {
 
             Token closeBr = tokenStream.getNextToken(); // expect ']'
             if (closeBr.type != TOKEN_R_BRACKET) {
-                reportError("Expected ']' after array index.", closeBr.lineNumber);
+                reportError(DIAG_EXPECTED_CLOSE_ARRAY_INDEX, closeBr.lineNumber);
                 delete indexExpr;
                 return nullptr;
             }
 
             Token assignTok = tokenStream.getNextToken(); // expect '='
             if (assignTok.type != TOKEN_ASSIGNMENT_OPERATOR) {
-                reportError("Expected '=' after array element.", assignTok.lineNumber);
+                reportError(DIAG_EXPECTED_ELEMENT_ASSIGNMENT, assignTok.lineNumber);
                 delete indexExpr;
                 return nullptr;
             }
@@ -488,7 +627,7 @@ CSTNode* Parser::parseStatement() {
 
             Token semi = tokenStream.getNextToken(); // expect ';'
             if (semi.type != TOKEN_SEMICOLON) {
-                reportError("Expected ';' after assignment.", semi.lineNumber);
+                reportError(DIAG_EXPECTED_ASSIGNMENT_SEMICOLON, semi.lineNumber);
                 delete indexExpr; delete rhs;
                 return nullptr;
             }
@@ -513,7 +652,7 @@ CSTNode* Parser::parseStatement() {
 
             Token semi = tokenStream.getNextToken();
             if (semi.type != TOKEN_SEMICOLON) {
-                reportError("Expected ';' after assignment statement.", semi.lineNumber);
+                reportError(DIAG_EXPECTED_ASSIGNMENT_STATEMENT_SEMICOLON, semi.lineNumber);
                 delete assignNode;
                 return nullptr;
             }
@@ -532,7 +671,7 @@ CSTNode* Parser::parseStatement() {
 
             Token semi = tokenStream.getNextToken();
             if (semi.type != TOKEN_SEMICOLON) {
-                reportError("Expected ';' after function call.", semi.lineNumber);
+                reportError(DIAG_EXPECTED_CALL_SEMICOLON, semi.lineNumber);
                 delete callNode;
                 return nullptr;
             }
@@ -540,16 +679,17 @@ CSTNode* Parser::parseStatement() {
         }
 
         // anything else after an identifier is invalid here 
-        reportError("Invalid statement.", token.lineNumber);
+        reportError(DIAG_INVALID_STATEMENT, token.lineNumber);
         return nullptr;
     }
     
     if (token.type == TOKEN_KEYWORD && token.value == "if") {  // handling "if" statements
         CSTNode* ifNode = new CSTNode("IfStatement", token.value, token.lineNumber);
+        StreamScope ifScope(*this, ifNode);
 
         token = tokenStream.getNextToken();
         if (token.type != TOKEN_L_PAREN) {
-            reportError("Expected '(' after 'if' keyword.", token.lineNumber);
+            reportError(DIAG_EXPECTED_IF_OPEN, token.lineNumber);
             delete ifNode;
             return nullptr;
         }
@@ -560,18 +700,18 @@ CSTNode* Parser::parseStatement() {
             delete ifNode;
             return nullptr;
         }
-        ifNode->addChild(conditionNode);
+        attach(ifNode, conditionNode);
 
         token = tokenStream.getNextToken();
         if (token.type != TOKEN_R_PAREN) {
-            reportError("Expected ')' after 'if' condition.", token.lineNumber);
+            reportError(DIAG_EXPECTED_IF_CLOSE, token.lineNumber);
             delete ifNode;
             return nullptr;
         }
 
         token = tokenStream.getNextToken();
         if (token.type != TOKEN_L_BRACE) {
-            reportError("Expected '{' after 'if' condition.", token.lineNumber);
+            reportError(DIAG_EXPECTED_IF_BODY, token.lineNumber);
             delete ifNode;
             return nullptr;
         }
@@ -582,10 +722,10 @@ CSTNode* Parser::parseStatement() {
             if (token.type == TOKEN_R_BRACE) break;
 
             tokenStream.rewind();
-            CSTNode* statementNode = parseStatement();
+            CSTNode* statementNode = parseStatementOrRecover();
 
             if (statementNode) {
-                ifNode->addChild(statementNode);
+                attach(ifNode, statementNode);
             }
         }
         // now check for an `else` statement after the closing brace of the `if` block
@@ -594,11 +734,12 @@ CSTNode* Parser::parseStatement() {
             tokenStream.getNextToken();  // Consume the 'else'
             
             CSTNode* elseNode = new CSTNode("ElseStatement", "else", nextToken.lineNumber);
+            StreamScope elseScope(*this, elseNode);
 
             // the else block should start with a '{'
             token = tokenStream.getNextToken();
             if (token.type != TOKEN_L_BRACE) {
-                reportError("Expected '{' after 'else' keyword.", token.lineNumber);
+                reportError(DIAG_EXPECTED_ELSE_BODY, token.lineNumber);
                 delete ifNode;
                 delete elseNode;
                 return nullptr;
@@ -610,14 +751,15 @@ CSTNode* Parser::parseStatement() {
                 if (token.type == TOKEN_R_BRACE) break;
 
                 tokenStream.rewind();
-                CSTNode* elseStatementNode = parseStatement();
+                CSTNode* elseStatementNode = parseStatementOrRecover();
 
                 if (elseStatementNode) {
-                    elseNode->addChild(elseStatementNode);
+                    attach(elseNode, elseStatementNode);
                 }
             }
             
-            ifNode->addChild(elseNode);  // attach the 'else' block to the 'if' node
+            elseScope.close();
+            attach(ifNode, elseNode);  // attach the 'else' block to the 'if' node
         }
         
         return ifNode;
@@ -639,7 +781,7 @@ CSTNode* Parser::parseStatement() {
 
             token = tokenStream.getNextToken();
             if (token.type != TOKEN_SEMICOLON) {
-                reportError("Expected ';' after return statement.", token.lineNumber);
+                reportError(DIAG_EXPECTED_RETURN_SEMICOLON, token.lineNumber);
                 delete returnNode;
                 return nullptr;
             }
@@ -650,10 +792,11 @@ CSTNode* Parser::parseStatement() {
 
     if (token.type == TOKEN_KEYWORD && token.value == "while") {  // handling "while" statements
         CSTNode* whileNode = new CSTNode("WhileStatement", token.value, token.lineNumber);
+        StreamScope whileScope(*this, whileNode);
     
         token = tokenStream.getNextToken();
         if (token.type != TOKEN_L_PAREN) {
-            reportError("Expected '(' after 'while' keyword.", token.lineNumber);
+            reportError(DIAG_EXPECTED_WHILE_OPEN, token.lineNumber);
             delete whileNode;
             return nullptr;
         }
@@ -664,18 +807,18 @@ CSTNode* Parser::parseStatement() {
             delete whileNode;
             return nullptr;
         }
-        whileNode->addChild(conditionNode);
+        attach(whileNode, conditionNode);
     
         token = tokenStream.getNextToken();
         if (token.type != TOKEN_R_PAREN) {
-            reportError("Expected ')' after 'while' condition.", token.lineNumber);
+            reportError(DIAG_EXPECTED_WHILE_CLOSE, token.lineNumber);
             delete whileNode;
             return nullptr;
         }
     
         token = tokenStream.getNextToken();
         if (token.type != TOKEN_L_BRACE) {
-            reportError("Expected '{' after 'while' condition.", token.lineNumber);
+            reportError(DIAG_EXPECTED_WHILE_BODY, token.lineNumber);
             delete whileNode;
             return nullptr;
         }
@@ -686,17 +829,17 @@ CSTNode* Parser::parseStatement() {
             if (token.type == TOKEN_R_BRACE) break;
     
             tokenStream.rewind();
-            CSTNode* statementNode = parseStatement();
+            CSTNode* statementNode = parseStatementOrRecover();
     
             if (statementNode) {
-                whileNode->addChild(statementNode);
+                attach(whileNode, statementNode);
             }
         }
     
         return whileNode;
     }
     
-    reportError("Invalid statement.", token.lineNumber);
+    reportError(DIAG_INVALID_STATEMENT, token.lineNumber);
     return nullptr;
 }
 
@@ -705,7 +848,7 @@ CSTNode* Parser::parseDeclaration() {
     Token nameToken = tokenStream.getNextToken();
 
     if (nameToken.type != TOKEN_IDENTIFIER) {
-        reportError("Expected identifier in declaration.", nameToken.lineNumber);
+        reportError(DIAG_EXPECTED_DECLARATION_IDENTIFIER, nameToken.lineNumber);
         return nullptr;
     }
 
@@ -718,7 +861,7 @@ CSTNode* Parser::parseAssignment() {
     Token assignmentToken = tokenStream.getNextToken();
 
     if (assignmentToken.type != TOKEN_ASSIGNMENT_OPERATOR) {
-        reportError("Expected '=' in assignment statement.", assignmentToken.lineNumber);
+        reportError(DIAG_EXPECTED_ASSIGNMENT_OPERATOR, assignmentToken.lineNumber);
         return nullptr;
     }
 
@@ -786,7 +929,7 @@ CSTNode* Parser::parseExpression(CSTNode* leftHandSide, bool stopAtParen) {
                     if (argToken.type == TOKEN_COMMA) {
                         tokenStream.getNextToken();  // consume the comma
                     } else if (argToken.type != TOKEN_R_PAREN) {
-                        reportError("Expected ',' or ')' in function call argument list.", argToken.lineNumber);
+                        reportError(DIAG_EXPECTED_ARGUMENT_SEPARATOR, argToken.lineNumber);
                         delete functionCallNode;
                         return nullptr;
                     }
@@ -809,7 +952,7 @@ CSTNode* Parser::parseExpression(CSTNode* leftHandSide, bool stopAtParen) {
 
                 Token closingBracketToken = tokenStream.getNextToken();  // consume ']'
                 if (closingBracketToken.type != TOKEN_R_BRACKET) {
-                    reportError("Expected ']' after array index.", closingBracketToken.lineNumber);
+                    reportError(DIAG_EXPECTED_CLOSE_ARRAY_INDEX, closingBracketToken.lineNumber);
                     delete arrayAccessNode;
                     return nullptr;
                 }
@@ -842,7 +985,7 @@ CSTNode* Parser::parseExpression(CSTNode* leftHandSide, bool stopAtParen) {
                     // allow loop to continue
                 } 
             } else {
-                reportError("Expected ')' after expression.", token.lineNumber);
+                reportError(DIAG_EXPECTED_CLOSE_PAREN, token.lineNumber);
                 delete leftHandSide;
                 return nullptr;
             }
@@ -858,7 +1001,9 @@ CSTNode* Parser::parseExpression(CSTNode* leftHandSide, bool stopAtParen) {
         }
         // case 8: escape sequences (e.g., "name = 'Robert\x0';")
         else if (token.type == TOKEN_UNKNOWN && token.value == "\\") {  // handle escape sequences starting with '\'
+#ifdef DEBUG
             std::cout << "Found backslash delimiter: " << token.value << " on Line: " << token.lineNumber << std::endl;
+#endif
         
             Token nextToken = tokenStream.getNextToken();
         
@@ -867,13 +1012,13 @@ CSTNode* Parser::parseExpression(CSTNode* leftHandSide, bool stopAtParen) {
                 CSTNode* escapeNode = new CSTNode("EscapeSequence", "\\" + nextToken.value, token.lineNumber);
                 leftHandSide = escapeNode;
             } else {
-                reportError("Invalid or unrecognized escape sequence: \\" + nextToken.value, token.lineNumber);
+                reportError(DIAG_INVALID_ESCAPE, token.lineNumber, nextToken.value);
                 return nullptr;
             }
         }
         
         else {
-            reportError("Invalid expression.", token.lineNumber);
+            reportError(DIAG_INVALID_EXPRESSION, token.lineNumber);
             return nullptr;
         }
     }
@@ -884,7 +1029,9 @@ CSTNode* Parser::parseExpression(CSTNode* leftHandSide, bool stopAtParen) {
 
         // stop if we encounter a ')' when 'stopAtParen' is true
         if (stopAtParen && token.type == TOKEN_R_PAREN) {
+#ifdef DEBUG
             std::cout << "Stopping expression parsing due to encountering ')'.\n";
+#endif
             break;
         }
 
@@ -943,6 +1090,6 @@ CSTNode* Parser::parseTerm() {
     if (token.type == TOKEN_INTEGER || token.type == TOKEN_IDENTIFIER) {
         return new CSTNode("Term", token.value, token.lineNumber);
     }
-    reportError("Expected integer or identifier in expression.", token.lineNumber);
+    reportError(DIAG_EXPECTED_OPERAND, token.lineNumber);
     return nullptr;
 }
@@ -6,12 +6,18 @@
 #include "Tokenizer.h"
 #include "ErrorHandler.h"
 #include "SymbolTable.h"
+#include "TopLevelSegments.h"
+#include "CSTListener.h"
 
 class Parser {
 private:
     TokenStream& tokenStream;
     ErrorHandler& errorHandler;
     SymbolTable symbolTable; 
+    CSTListener* listener;
+
+    class StreamScope;
+    void attach(CSTNode* parent, CSTNode* child);
 
     CSTNode* parseProcedure(const std::string& nodeType, const Token& returnTypeToken);
     CSTNode* parseStatement();
@@ -22,11 +28,31 @@ private:
     CSTNode* parseDeclaration();
     CSTNode* parseAssignment();
 
-    void reportError(const std::string& message, int lineNumber);
+    CSTNode* parseTopLevelItem();
+    CSTNode* parseStatementOrRecover();
+    void synchronize(int failedAt);
+    bool isDefinitionStart(const Token& token) const;
+
+    template <typename... Args>
+    void reportError(DiagnosticCode code, int lineNumber, const Args&... args) {
+        errorHandler.report(code, lineNumber, args...);
+    }
 
 public:
     Parser(TokenStream& tokenStream, ErrorHandler& errorHandler);
+    Parser(TokenStream& tokenStream, ErrorHandler& errorHandler, const SymbolTable& initialTable);
     CSTNode* parseProgram();
+    // streaming mode: nodes are handed to the listener as they complete and freed, so
+    // parseProgram returns an empty Program node and memory stays proportional to the
+    // nesting depth. after a syntax error the stream may hold a partial construct
+    void setListener(CSTListener* streamListener) { listener = streamListener; }
+    // same tree, symbol table and errors as parseProgram, but top-level definitions are
+    // parsed concurrently on threadCount threads (0 = one per core). See ParserParallel.cpp
+    CSTNode* parseProgramParallel(unsigned int threadCount = 0);
+
+    // parses one top-level segment of `tokens` on its own (parallel and incremental modes)
+    static void parseSegment(const std::vector<Token>& tokens, const TopLevelSegment& segment,
+                             const SymbolTable& seed, SegmentResult& result);
     SymbolTable& getSymbolTable() { return symbolTable; }
 
 };
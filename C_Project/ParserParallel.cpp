@@ -0,0 +1,171 @@
+#include "Parser.h"
+#include "ThreadPool.h"
+#include "TopLevelSegments.h"
+#include "Trace.h"
+#include <memory>
+#include <unordered_set>
+
+// parallel front end for Parser::parseProgram.
+//
+// after tokenization the extent of every top-level procedure/function is found by
+// brace matching over the token list. the runs of top-level statements between
+// definitions (global declarations) are parsed in order on the calling thread, and
+// every definition is parsed on the pool by its own Parser, seeded with the globals
+// declared before it -- the only symbol table state a definition's checks can see.
+// each worker allocates its own nodes, symbol table and error list; the pieces are
+// then merged in source order with scope numbers renumbered to continue from the
+// previous definition, which reproduces the serial tree, table and error list.
+//
+// a segment whose parse did not end exactly on its own last token (error recovery ran
+// into a neighbour, unbalanced braces, ...) could have behaved differently in a serial
+// parse, so in that case everything is thrown away and the file is parsed serially.
+
+namespace {
+
+bool isDefinitionToken(const Token& token) {
+    return token.type == TOKEN_PROCEDURE || token.type == TOKEN_FUNCTION;
+}
+
+// name token of the definition starting at `begin` ("procedure name" / "function type name")
+const Token* definitionName(const std::vector<Token>& tokens, size_t begin) {
+    size_t nameIndex = begin + (tokens[begin].type == TOKEN_FUNCTION ? 2 : 1);
+    return nameIndex < tokens.size() ? &tokens[nameIndex] : nullptr;
+}
+
+} // namespace
+
+bool findTopLevelSegments(const std::vector<Token>& tokens, size_t begin, std::vector<TopLevelSegment>& segments) {
+    std::unordered_set<std::string> names;
+    size_t i = begin;
+
+    while (i < tokens.size()) {
+        if (isDefinitionToken(tokens[i])) {
+            // parameter lists are appended to by name, so a repeated name ties two
+            // definitions together; leave those files to the serial parser
+            const Token* name = definitionName(tokens, i);
+            if (!name || !names.insert(name->value).second) return false;
+
+            size_t j = i + 1;
+            while (j < tokens.size() && tokens[j].type != TOKEN_L_BRACE) {
+                if (isDefinitionToken(tokens[j])) return false;
+                j++;
+            }
+            int depth = 0;
+            for (; j < tokens.size(); ++j) {
+                if (tokens[j].type == TOKEN_L_BRACE) {
+                    depth++;
+                } else if (tokens[j].type == TOKEN_R_BRACE) {
+                    if (--depth == 0) break;
+                } else if (isDefinitionToken(tokens[j])) {
+                    return false;
+                }
+            }
+            if (j >= tokens.size()) return false;  // body never closed
+
+            segments.push_back({i, j + 1, true});
+            i = j + 1;
+        }
+        else {
+            size_t j = i;
+            int depth = 0;
+            while (j < tokens.size() && !isDefinitionToken(tokens[j])) {
+                if (tokens[j].type == TOKEN_L_BRACE) depth++;
+                else if (tokens[j].type == TOKEN_R_BRACE && depth > 0) depth--;
+                j++;
+            }
+            if (depth != 0) return false;
+
+            segments.push_back({i, j, false});
+            i = j;
+        }
+    }
+    return true;
+}
+
+// parses tokens[segment] into result with a parser of its own, seeded with `seed`
+void Parser::parseSegment(const std::vector<Token>& tokens, const TopLevelSegment& segment,
+                          const SymbolTable& seed, SegmentResult& result) {
+    TokenStream window(tokens, segment.begin, segment.end);
+    Parser parser(window, result.errors, seed);
+    result.firstEntry = seed.getEntryCount();
+
+    while (window.hasMoreTokens() && static_cast<size_t>(window.getCurrentIndex()) < segment.end) {
+        if (CSTNode* item = parser.parseTopLevelItem()) {
+            result.nodes.push_back(item);
+        }
+    }
+    result.matchesSerial = static_cast<size_t>(window.getCurrentIndex()) == segment.end &&
+                           !window.consumedPastWindow();
+    result.table = std::move(parser.symbolTable);
+}
+
+CSTNode* Parser::parseProgramParallel(unsigned int threadCount) {
+    TRACE_SCOPE("Parser::parseProgramParallel");
+    const std::vector<Token>& tokens = tokenStream.getTokens();
+    size_t start = tokenStream.getCurrentIndex();
+
+    std::vector<TopLevelSegment> segments;
+    if (listener || !findTopLevelSegments(tokens, start, segments)) {  // streaming is inherently in order
+        return parseProgram();
+    }
+
+    size_t definitionCount = 0;
+    for (const TopLevelSegment& segment : segments) {
+        if (segment.isDefinition) definitionCount++;
+    }
+    if (threadCount == 0) threadCount = ThreadPool::defaultThreadCount();
+    if (definitionCount < 2 || threadCount < 2) {
+        return parseProgram();
+    }
+
+    std::vector<std::unique_ptr<SegmentResult>> results;
+    SymbolTable globals = symbolTable;  // what top-level statements have declared so far
+    {
+        ThreadPool pool(std::min<size_t>(threadCount, definitionCount));
+
+        for (const TopLevelSegment& segment : segments) {
+            results.emplace_back(new SegmentResult());
+            SegmentResult* result = results.back().get();
+
+            if (segment.isDefinition) {
+                pool.submit([&tokens, segment, globals, result] {
+                    parseSegment(tokens, segment, globals, *result);
+                });
+            } else {
+                parseSegment(tokens, segment, globals, *result);
+                globals.append(result->table, result->firstEntry, 0);
+            }
+        }
+        pool.wait();
+    }
+
+    bool matchesSerial = true;
+    for (const auto& result : results) {
+        matchesSerial = matchesSerial && result->matchesSerial;
+    }
+    if (!matchesSerial) {
+        for (const auto& result : results) {
+            for (CSTNode* node : result->nodes) deleteTree(node);
+        }
+        return parseProgram();  // nothing has touched this parser's state yet
+    }
+
+    // stitch the pieces together in source order
+    CSTNode* root = new CSTNode("Program");
+    CSTNode* last = nullptr;
+    int scopeOffset = symbolTable.getScopesUsed();
+
+    for (const auto& result : results) {
+        for (CSTNode* node : result->nodes) {
+            if (last) last->rightSibling = node;
+            else root->leftChild = node;
+            last = node;
+        }
+        symbolTable.append(result->table, result->firstEntry, scopeOffset);
+        scopeOffset += result->table.getScopesUsed();
+        errorHandler.appendErrors(result->errors);
+    }
+
+    tokenStream.skipToEnd();
+    return root;
+}
@@ -0,0 +1,16 @@
+#include "StringInterner.h"
+
+uint32_t StringInterner::intern(const std::string& text) {
+    auto found = ids.find(text);
+    if (found != ids.end()) return found->second;
+
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    strings.push_back(text);
+    ids.emplace(text, id);
+    return id;
+}
+
+uint32_t StringInterner::find(const std::string& text) const {
+    auto found = ids.find(text);
+    return found == ids.end() ? NONE : found->second;
+}
@@ -0,0 +1,24 @@
+#ifndef STRING_INTERNER_H
+#define STRING_INTERNER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// maps each distinct string to a small dense id so tables can key on integers
+class StringInterner {
+public:
+    static const uint32_t NONE = 0xFFFFFFFFu;
+
+    uint32_t intern(const std::string& text);
+    uint32_t find(const std::string& text) const;  // NONE if never interned
+    const std::string& lookup(uint32_t id) const { return strings[id]; }
+    size_t size() const { return strings.size(); }
+
+private:
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<std::string> strings;
+};
+
+#endif
@@ -1,58 +1,163 @@
 #include "SymbolTable.h"
+#include "Trace.h"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <stdexcept>
 
-void SymbolTable::addEntry(const SymbolTableEntry& entry)
+DeclareResult SymbolTable::tryAddEntry(const SymbolTableEntry& entry, const SymbolTableEntry** conflict)
 {
-    //case:same‑scope duplicates
-    if (isDefinedInCurrentScope(entry.identifierName, entry.scope)) {
-        throw std::runtime_error("variable \"" + entry.identifierName +
-                                 "\" is already defined locally");
-    }
+    TRACE_SCOPE("SymbolTable::tryAddEntry");
+    const SymbolTableEntry* earlier = nullptr;
+    DeclareResult result = DECLARE_OK;
+    uint32_t name = names.find(entry.identifierName);
 
-    ///case:duplicates a parameter of this procedure 
-    if (isInParameterList(entry.identifierName, entry.scope)) {
-        throw std::runtime_error("variable \"" + entry.identifierName +
-                                 "\" is already defined locally");
-    }
+    if (name != StringInterner::NONE) {
+        //case:same‑scope duplicates
+        if (const ScopeInfo* scope = findScope(entry.scope)) {
+            auto found = scope->symbols.find(name);
+            if (found != scope->symbols.end()) {
+                earlier = &entries[found->second];
+                result = DECLARE_DUPLICATE_LOCAL;
+            }
 
-    //case:shadowing a global name
-    if (entry.scope != 0 && isDefinedGlobally(entry.identifierName)) {
-        throw std::runtime_error("variable \"" + entry.identifierName +
-                                 "\" is already defined globally");
+            ///case:duplicates a parameter of this procedure 
+            if (!earlier && scope->owner != StringInterner::NONE) {
+                auto list = parameterListIndex.find(scope->owner);
+                if (list != parameterListIndex.end()) {
+                    auto param = parameterIndexes[list->second].names.find(name);
+                    if (param != parameterIndexes[list->second].names.end()) {
+                        earlier = &parameterLists[list->second].second[param->second];
+                        result = DECLARE_DUPLICATE_PARAMETER;
+                    }
+                }
+            }
+        }
+
+        //case:shadowing a global name
+        if (!earlier && entry.scope != 0) {
+            auto found = scopes[0].symbols.find(name);
+            if (found != scopes[0].symbols.end()) {
+                earlier = &entries[found->second];
+                result = DECLARE_DUPLICATE_GLOBAL;
+            }
+        }
     }
 
+    if (conflict) *conflict = earlier;
+    if (result != DECLARE_OK) return result;
+
     entries.push_back(entry);
+    indexEntry(entries.size() - 1);
+    return DECLARE_OK;
+}
+
+void SymbolTable::addEntry(const SymbolTableEntry& entry)
+{
+    DeclareResult result = tryAddEntry(entry);
+    if (result != DECLARE_OK) {
+        throw std::runtime_error(describeConflict(result, entry.identifierName));
+    }
+}
+
+DiagnosticCode SymbolTable::conflictDiagnostic(DeclareResult result)
+{
+    return result == DECLARE_DUPLICATE_GLOBAL ? DIAG_DUPLICATE_GLOBAL : DIAG_DUPLICATE_LOCAL;
+}
+
+std::string SymbolTable::describeConflict(DeclareResult result, const std::string& name)
+{
+    if (result == DECLARE_OK) return "";
+    return formatDiagnostic(makeDiagnostic(conflictDiagnostic(result), 0, name));
 }
 
 void SymbolTable::addFunctionParameter(const std::string& functionName, const SymbolTableEntry& param) {
-    for (auto& pair : parameterLists) {
-        if (pair.first == functionName) {
-            pair.second.push_back(param);
-            return;
+    uint32_t owner = names.intern(functionName);
+    uint32_t paramName = names.intern(param.identifierName);
+
+    auto found = parameterListIndex.find(owner);
+    if (found == parameterListIndex.end()) {
+        found = parameterListIndex.emplace(owner, parameterLists.size()).first;
+        parameterLists.push_back({functionName, {}});
+        parameterIndexes.emplace_back();
+    }
+    std::vector<SymbolTableEntry>& list = parameterLists[found->second].second;
+    parameterIndexes[found->second].names.emplace(paramName, list.size());
+    list.push_back(param);
+}
+
+SymbolTable::ScopeInfo& SymbolTable::scopeInfo(int scope) {
+    if (static_cast<size_t>(scope) >= scopes.size()) scopes.resize(scope + 1);
+    return scopes[scope];
+}
+
+const SymbolTable::ScopeInfo* SymbolTable::findScope(int scope) const {
+    if (scope < 0 || static_cast<size_t>(scope) >= scopes.size()) return nullptr;
+    return &scopes[scope];
+}
+
+// the first procedure/function entered in a scope owns it (its parameters live there)
+void SymbolTable::indexEntry(size_t index) {
+    const SymbolTableEntry& entry = entries[index];
+    uint32_t name = names.intern(entry.identifierName);
+    ScopeInfo& scope = scopeInfo(entry.scope);
+    scope.symbols.emplace(name, index);
+    if ((entry.identifierType == IDENTIFIER_PROCEDURE || entry.identifierType == IDENTIFIER_FUNCTION) &&
+        scope.owner == StringInterner::NONE) {
+        scope.owner = name;
+    }
+}
+
+// appends part's entries from firstEntry on and all of its parameter lists, shifting
+// every non-global scope by scopeOffset so the numbering continues from this table
+void SymbolTable::append(const SymbolTable& part, size_t firstEntry, int scopeOffset) {
+    TRACE_SCOPE("SymbolTable::append");
+    for (size_t i = firstEntry; i < part.entries.size(); ++i) {
+        SymbolTableEntry entry = part.entries[i];
+        if (entry.scope != 0) entry.scope += scopeOffset;
+        entries.push_back(entry);
+        indexEntry(entries.size() - 1);
+    }
+    for (size_t scope = 1; scope < part.scopes.size(); ++scope) {
+        int parent = part.scopes[scope].parent;
+        scopeInfo(static_cast<int>(scope) + scopeOffset).parent = parent != 0 ? parent + scopeOffset : 0;
+    }
+    for (const auto& paramList : part.parameterLists) {
+        for (SymbolTableEntry param : paramList.second) {
+            if (param.scope != 0) param.scope += scopeOffset;
+            addFunctionParameter(paramList.first, param);
         }
     }
-    parameterLists.push_back({functionName, {param}});
+    nextScopeId = std::max(nextScopeId, part.nextScopeId + scopeOffset);
+}
+
+void printSymbolEntry(const SymbolTableEntry& entry, std::ostream& out) {
+    out << "IDENTIFIER_NAME: " << entry.identifierName << "\n";
+    out << "IDENTIFIER_TYPE: " << identifierKindToString(entry.identifierType) << "\n";
+    out << "DATATYPE: " << dataTypeToString(entry.dataType) << "\n";
+    out << "DATATYPE_IS_ARRAY: " << (entry.isArray ? "yes" : "no") << "\n";
+    out << "DATATYPE_ARRAY_SIZE: " << entry.arraySize << "\n";
+    out << "SCOPE: " << entry.scope << "\n" << "\n";
+}
+
+void printParameterEntry(const SymbolTableEntry& param, std::ostream& out) {
+    out << "IDENTIFIER_NAME: " << param.identifierName << "\n";
+    out << "DATATYPE: " << dataTypeToString(param.dataType) << "\n";
+    out << "DATATYPE_IS_ARRAY: " << (param.isArray ? "yes" : "no") << "\n";
+    out << "DATATYPE_ARRAY_SIZE: " << param.arraySize << "\n";
+    out << "SCOPE: " << param.scope << "\n" << "\n";
 }
 
 void SymbolTable::printTable(std::ostream& out) const {
+    TRACE_SCOPE("SymbolTable::printTable");
     for (const auto& entry : entries) {
-        out << "IDENTIFIER_NAME: " << entry.identifierName << "\n";
-        out << "IDENTIFIER_TYPE: " << entry.identifierType << "\n";
-        out << "DATATYPE: " << entry.dataType << "\n";
-        out << "DATATYPE_IS_ARRAY: " << (entry.isArray ? "yes" : "no") << "\n";
-        out << "DATATYPE_ARRAY_SIZE: " << entry.arraySize << "\n";
-        out << "SCOPE: " << entry.scope << "\n" << "\n";
+        printSymbolEntry(entry, out);
     }
 
     for (const auto& paramList : parameterLists) {
         out << "PARAMETER LIST FOR: " << paramList.first << "\n";
         for (const auto& param : paramList.second) {
-            out << "IDENTIFIER_NAME: " << param.identifierName << "\n";
-            out << "DATATYPE: " << param.dataType << "\n";
-            out << "DATATYPE_IS_ARRAY: " << (param.isArray ? "yes" : "no") << "\n";
-            out << "DATATYPE_ARRAY_SIZE: " << param.arraySize << "\n";
-            out << "SCOPE: " << param.scope << "\n" << "\n";
+            printParameterEntry(param, out);
         }
     }
 }
@@ -60,7 +165,9 @@ void SymbolTable::printTable(std::ostream& out) const {
 void SymbolTable::enterScope()
 {
     scopeStack.push_back(currentScope);   // remember where we came from
+    int parent = currentScope;
     currentScope = nextScopeId++;         // assign a unique number
+    scopeInfo(currentScope).parent = parent;
 }
 
 void SymbolTable::exitScope()
@@ -76,47 +183,81 @@ int SymbolTable::getCurrentScopeLevel() const {
     return currentScope;
 }
 
-bool SymbolTable::isDefinedInCurrentScope(const std::string& name,
-    int current) const
+bool SymbolTable::isDefinedInCurrentScope(const std::string& name, int current) const
 {
-for (const auto& e : entries) {
-if (e.identifierName == name && e.scope == current) {
-return true;            // duplicate in the same block
-}
-}
-return false;
+    const ScopeInfo* scope = findScope(current);
+    uint32_t id = names.find(name);
+    return scope && id != StringInterner::NONE && scope->symbols.count(id);
 }
 
 bool SymbolTable::isDefinedGlobally(const std::string& name) const
 {
-for (const auto& e : entries) {
-if (e.identifierName == name && e.scope == 0) {
-return true;            // already a global symbol
-}
-}
-return false;
+    return isDefinedInCurrentScope(name, 0);
 }
 
 bool SymbolTable::isInParameterList(const std::string& name, int currentScope) const
 {
     //  which procedure/function owns currentScope  
-    std::string owner; // procedure/function name
-    for (const auto& e : entries) {
-        if ((e.identifierType == "procedure" || e.identifierType == "function") &&
-            e.scope == currentScope) {
-            owner = e.identifierName;
-            break;
-        }
-    }
-    if (owner.empty()) return false;
+    const ScopeInfo* scope = findScope(currentScope);
+    if (!scope || scope->owner == StringInterner::NONE) return false;
 
     // search that parameter list
-    for (const auto& pair : parameterLists) {
-        if (pair.first == owner) {
-            for (const auto& p : pair.second) {
-                if (p.identifierName == name) return true;
+    auto list = parameterListIndex.find(scope->owner);
+    uint32_t id = names.find(name);
+    return list != parameterListIndex.end() && id != StringInterner::NONE &&
+           parameterIndexes[list->second].names.count(id);
+}
+
+const SymbolTableEntry* SymbolTable::lookup(const std::string& name, int scope) const
+{
+    uint32_t id = names.find(name);
+    if (id == StringInterner::NONE) return nullptr;
+
+    while (const ScopeInfo* info = findScope(scope)) {
+        auto found = info->symbols.find(id);
+        if (found != info->symbols.end()) return &entries[found->second];
+        if (scope == 0) break;
+        scope = info->parent;
+    }
+    return nullptr;
+}
+
+const SymbolTableEntry* SymbolTable::findParameter(const std::string& name, int scope) const
+{
+    uint32_t id = names.find(name);
+    if (id == StringInterner::NONE) return nullptr;
+
+    while (const ScopeInfo* info = findScope(scope)) {
+        if (info->owner != StringInterner::NONE) {
+            auto list = parameterListIndex.find(info->owner);
+            if (list != parameterListIndex.end()) {
+                auto found = parameterIndexes[list->second].names.find(id);
+                if (found != parameterIndexes[list->second].names.end()) {
+                    return &parameterLists[list->second].second[found->second];
+                }
             }
         }
+        if (scope == 0) break;
+        scope = info->parent;
     }
-    return false;
-}
\ No newline at end of file
+    return nullptr;
+}
+
+const std::vector<SymbolTableEntry>* SymbolTable::getParameterList(const std::string& functionName) const
+{
+    auto list = parameterListIndex.find(names.find(functionName));
+    return list == parameterListIndex.end() ? nullptr : &parameterLists[list->second].second;
+}
+
+int SymbolTable::getParentScope(int scope) const
+{
+    const ScopeInfo* info = findScope(scope);
+    return info ? info->parent : 0;
+}
+
+std::string SymbolTable::getScopeOwner(int scope) const
+{
+    const ScopeInfo* info = findScope(scope);
+    if (!info || info->owner == StringInterner::NONE) return "";
+    return names.lookup(info->owner);
+}
@@ -1,22 +1,38 @@
 #ifndef SYMBOL_TABLE_H
 #define SYMBOL_TABLE_H
 
+#include "DataType.h"
+#include "Diagnostic.h"
+#include "StringInterner.h"
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <iostream>
 
+// the small fields are packed behind the name; printTable spells the enums out
 struct SymbolTableEntry {
     std::string identifierName;
-    std::string identifierType; // function, procedure, datatype, parameter
-    std::string dataType;
+    int32_t arraySize;
+    int32_t scope;
+    IdentifierKind identifierType;
+    DataType dataType;
     bool isArray;
-    int arraySize;
-    int scope;
+};
+
+// outcome of SymbolTable::tryAddEntry
+enum DeclareResult {
+    DECLARE_OK,
+    DECLARE_DUPLICATE_LOCAL,      // same name already in this scope
+    DECLARE_DUPLICATE_PARAMETER,  // same name as a parameter of the owning procedure/function
+    DECLARE_DUPLICATE_GLOBAL      // a non-global reusing a global name
 };
 
 class SymbolTable {
 public:
-    void addEntry(const SymbolTableEntry& entry);
+    // adds entry unless it clashes with an earlier declaration. on a clash nothing is
+    // added and conflict (if given) points at the earlier entry or parameter
+    DeclareResult tryAddEntry(const SymbolTableEntry& entry, const SymbolTableEntry** conflict = nullptr);
+    void addEntry(const SymbolTableEntry& entry);  // throws std::runtime_error on a clash
     void addFunctionParameter(const std::string& functionName, const SymbolTableEntry& param);
     void printTable(std::ostream& out = std::cout) const;
     void enterScope();
@@ -26,13 +42,61 @@ public:
     bool isDefinedGlobally(const std::string& name) const;
     bool isInParameterList(const std::string& name, int currentScope) const;
 
+    // used to parse top-level definitions separately and stitch the results together
+    size_t getEntryCount() const { return entries.size(); }
+    const SymbolTableEntry& getEntry(size_t index) const { return entries[index]; }
+    int getScopesUsed() const { return nextScopeId - 1; }
+    void append(const SymbolTable& part, size_t firstEntry, int scopeOffset);
+
+    // innermost declaration of name visible from scope, following the parent chain
+    // out to the globals; nullptr if there is none. parameters are not entries, see
+    // findParameter
+    const SymbolTableEntry* lookup(const std::string& name, int scope) const;
+    const SymbolTableEntry* findParameter(const std::string& name, int scope) const;
+    // parameters of a procedure/function in declaration order, nullptr if it has none
+    const std::vector<SymbolTableEntry>* getParameterList(const std::string& functionName) const;
+    int getParentScope(int scope) const;
+    const std::vector<std::pair<std::string, std::vector<SymbolTableEntry>>>& getParameterLists() const { return parameterLists; }
+    int getScopeCount() const { return static_cast<int>(scopes.size()); }  // valid ids are 0 .. count-1
+    // name of the procedure/function that opened scope, or "" (globals)
+    std::string getScopeOwner(int scope) const;
+
+    // the "variable "x" is already defined ..." diagnostic (argument: the name) for a failed tryAddEntry
+    static DiagnosticCode conflictDiagnostic(DeclareResult result);
+    static std::string describeConflict(DeclareResult result, const std::string& name);
+
     
     private:
+    // every lookup goes through these indexes; entries and parameterLists only keep
+    // declaration order for printTable
+    struct ScopeInfo {
+        int parent = 0;
+        uint32_t owner = StringInterner::NONE;             // interned procedure/function name
+        std::unordered_map<uint32_t, size_t> symbols;      // interned name -> index in entries
+    };
+
+    struct ParameterIndex {
+        std::unordered_map<uint32_t, size_t> names;        // interned name -> index in the list
+    };
+
+    ScopeInfo& scopeInfo(int scope);
+    const ScopeInfo* findScope(int scope) const;
+    void indexEntry(size_t index);
+
     std::vector<SymbolTableEntry> entries;
     std::vector<std::pair<std::string, std::vector<SymbolTableEntry>>> parameterLists;
 
+    StringInterner names;
+    std::vector<ScopeInfo> scopes = std::vector<ScopeInfo>(1);  // indexed by scope id, 0 is global
+    std::unordered_map<uint32_t, size_t> parameterListIndex;    // owner name -> index in parameterLists
+    std::vector<ParameterIndex> parameterIndexes;              // parallel to parameterLists
+
     int currentScope   = 0;          
     int nextScopeId    = 1;         
     std::vector<int> scopeStack;         
 };
+// the printTable blocks for one entry and one parameter, shared with the binary reader
+void printSymbolEntry(const SymbolTableEntry& entry, std::ostream& out);
+void printParameterEntry(const SymbolTableEntry& param, std::ostream& out);
+
 #endif
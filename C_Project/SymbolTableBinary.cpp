@@ -0,0 +1,158 @@
+#include "SymbolTableBinary.h"
+#include "Trace.h"
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+static SymbolBinaryEntry packEntry(const SymbolTableEntry& entry, BinaryStringTableBuilder& strings) {
+    return SymbolBinaryEntry{strings.add(entry.identifierName), entry.scope, entry.arraySize,
+                             static_cast<uint8_t>(entry.identifierType), static_cast<uint8_t>(entry.dataType),
+                             static_cast<uint8_t>(entry.isArray ? 1 : 0), 0};
+}
+
+bool writeSymbolTableBinary(const SymbolTable& table, const std::string& path) {
+    TRACE_SCOPE("writeSymbolTableBinary");
+    BinaryStringTableBuilder strings;
+    std::vector<SymbolBinaryEntry> entries;
+    std::vector<SymbolBinaryParameterList> lists;
+    std::vector<SymbolBinaryScope> scopes;
+
+    for (size_t i = 0; i < table.getEntryCount(); ++i) entries.push_back(packEntry(table.getEntry(i), strings));
+    uint32_t symbolCount = static_cast<uint32_t>(entries.size());
+
+    std::unordered_map<std::string, uint32_t> listByOwner;
+    for (const auto& list : table.getParameterLists()) {
+        listByOwner.emplace(list.first, static_cast<uint32_t>(lists.size()));
+        lists.push_back({strings.add(list.first), static_cast<uint32_t>(entries.size()), static_cast<uint32_t>(list.second.size())});
+        for (const SymbolTableEntry& param : list.second) entries.push_back(packEntry(param, strings));
+    }
+
+    for (int scope = 0; scope < table.getScopeCount(); ++scope) {
+        std::string owner = table.getScopeOwner(scope);
+        SymbolBinaryScope record{table.getParentScope(scope), SYMBOL_BINARY_NONE, SYMBOL_BINARY_NONE};
+        if (!owner.empty()) {
+            record.owner = strings.add(owner);
+            auto list = listByOwner.find(owner);
+            if (list != listByOwner.end()) record.parameterList = list->second;
+        }
+        scopes.push_back(record);
+    }
+
+    SymbolBinaryHeader header;
+    std::memcpy(header.magic, "SYMT", 4);
+    header.version = SYMBOL_BINARY_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.symbolCount = symbolCount;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.parameterListCount = static_cast<uint32_t>(lists.size());
+    header.scopeCount = static_cast<uint32_t>(scopes.size());
+    header.stringCount = strings.count();
+    header.stringBytes = strings.byteCount();
+    header.entryOffset = sizeof(SymbolBinaryHeader);
+    header.parameterListOffset = header.entryOffset + header.entryCount * sizeof(SymbolBinaryEntry);
+    header.scopeOffset = header.parameterListOffset + header.parameterListCount * sizeof(SymbolBinaryParameterList);
+    header.stringOffsetsOffset = header.scopeOffset + header.scopeCount * sizeof(SymbolBinaryScope);
+    header.stringDataOffset = header.stringOffsetsOffset + static_cast<uint32_t>(strings.offsetsSize());
+
+    std::vector<char> buffer(header.stringDataOffset + header.stringBytes);
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    if (!entries.empty()) std::memcpy(buffer.data() + header.entryOffset, entries.data(), entries.size() * sizeof(SymbolBinaryEntry));
+    if (!lists.empty()) std::memcpy(buffer.data() + header.parameterListOffset, lists.data(), lists.size() * sizeof(SymbolBinaryParameterList));
+    if (!scopes.empty()) std::memcpy(buffer.data() + header.scopeOffset, scopes.data(), scopes.size() * sizeof(SymbolBinaryScope));
+    strings.copyOffsets(buffer.data() + header.stringOffsetsOffset);
+    strings.copyData(buffer.data() + header.stringDataOffset);
+    return writeWholeFile(path, buffer);
+}
+
+bool MappedSymbolTable::open(const std::string& path) {
+    close();
+    if (!file.open(path)) return false;
+    if (file.size() < sizeof(SymbolBinaryHeader)) {
+        close();
+        return false;
+    }
+
+    const unsigned char* base = file.data();
+    header = reinterpret_cast<const SymbolBinaryHeader*>(base);
+    entries = reinterpret_cast<const SymbolBinaryEntry*>(base + header->entryOffset);
+    parameterLists = reinterpret_cast<const SymbolBinaryParameterList*>(base + header->parameterListOffset);
+    scopes = reinterpret_cast<const SymbolBinaryScope*>(base + header->scopeOffset);
+    strings.offsets = reinterpret_cast<const uint32_t*>(base + header->stringOffsetsOffset);
+    strings.data = reinterpret_cast<const char*>(base + header->stringDataOffset);
+    strings.count = header->stringCount;
+
+    if (!validate()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// checked once at load so the accessors can index without bounds checks
+bool MappedSymbolTable::validate() const {
+    if (std::memcmp(header->magic, "SYMT", 4) != 0 || header->version != SYMBOL_BINARY_VERSION ||
+        header->byteOrder != BYTE_ORDER_MARK) {
+        return false;
+    }
+    if (header->symbolCount > header->entryCount) return false;
+
+    struct Section { uint32_t offset; uint64_t size; };
+    const Section sections[] = {
+        {header->entryOffset, uint64_t(header->entryCount) * sizeof(SymbolBinaryEntry)},
+        {header->parameterListOffset, uint64_t(header->parameterListCount) * sizeof(SymbolBinaryParameterList)},
+        {header->scopeOffset, uint64_t(header->scopeCount) * sizeof(SymbolBinaryScope)},
+        {header->stringOffsetsOffset, (uint64_t(header->stringCount) + 1) * sizeof(uint32_t)},
+        {header->stringDataOffset, header->stringBytes},
+    };
+    for (const Section& section : sections) {
+        if (section.offset < sizeof(SymbolBinaryHeader) || section.offset % alignof(uint32_t) != 0 ||
+            section.offset + section.size > file.size()) {
+            return false;
+        }
+    }
+    if (!strings.validate(header->stringBytes)) return false;
+
+    for (uint32_t i = 0; i < header->entryCount; ++i) {
+        if (entries[i].name >= header->stringCount) return false;
+    }
+    for (uint32_t i = 0; i < header->parameterListCount; ++i) {
+        const SymbolBinaryParameterList& list = parameterLists[i];
+        if (list.owner >= header->stringCount || list.first < header->symbolCount ||
+            uint64_t(list.first) + list.count > header->entryCount) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header->scopeCount; ++i) {
+        const SymbolBinaryScope& scope = scopes[i];
+        if (scope.parent < 0 || uint32_t(scope.parent) >= header->scopeCount) return false;
+        if (scope.owner != SYMBOL_BINARY_NONE && scope.owner >= header->stringCount) return false;
+        if (scope.parameterList != SYMBOL_BINARY_NONE && scope.parameterList >= header->parameterListCount) return false;
+    }
+    return true;
+}
+
+void MappedSymbolTable::close() {
+    file.close();
+    header = nullptr;
+    entries = nullptr;
+    parameterLists = nullptr;
+    scopes = nullptr;
+    strings = BinaryStringTable();
+}
+
+SymbolTableEntry MappedSymbolTable::toEntry(uint32_t index) const {
+    const SymbolBinaryEntry& record = entries[index];
+    return SymbolTableEntry{std::string(strings.get(record.name)), record.arraySize, record.scope,
+                            static_cast<IdentifierKind>(record.identifierType), static_cast<DataType>(record.dataType),
+                            record.isArray != 0};
+}
+
+void MappedSymbolTable::printTable(std::ostream& out) const {
+    for (uint32_t i = 0; i < symbolCount(); ++i) printSymbolEntry(toEntry(i), out);
+
+    for (uint32_t i = 0; i < parameterListCount(); ++i) {
+        out << "PARAMETER LIST FOR: " << parameterListOwner(i) << "\n";
+        const SymbolBinaryParameterList& list = parameterLists[i];
+        for (uint32_t j = list.first; j < list.first + list.count; ++j) printParameterEntry(toEntry(j), out);
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef SYMBOL_TABLE_BINARY_H
+#define SYMBOL_TABLE_BINARY_H
+
+#include "BinaryStringTable.h"
+#include "ByteOrder.h"
+#include "MappedFile.h"
+#include "SymbolTable.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// binary symbol table format (symboltable_<file>.bin), host byte order:
+//
+//   header           magic "SYMT", version, BYTE_ORDER_MARK, then the counts and section offsets below
+//   entry array      entryCount fixed-size records. the first symbolCount are the table
+//                    entries in printTable order, the rest are the parameters grouped by list
+//   parameter lists  {owner name, first entry, entry count}: a range of the entry array
+//   scope tree       one record per scope id: {parent scope, owner name, parameter list}
+//   strings          string table shared by names (see BinaryStringTable.h)
+//
+// SYMBOL_BINARY_NONE marks a missing owner or parameter list
+const uint32_t SYMBOL_BINARY_VERSION = 2;
+const uint32_t SYMBOL_BINARY_NONE = 0xFFFFFFFFu;
+
+struct SymbolBinaryHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t symbolCount;
+    uint32_t entryCount;
+    uint32_t parameterListCount;
+    uint32_t scopeCount;
+    uint32_t stringCount;
+    uint32_t stringBytes;
+    uint32_t entryOffset;
+    uint32_t parameterListOffset;
+    uint32_t scopeOffset;
+    uint32_t stringOffsetsOffset;
+    uint32_t stringDataOffset;
+};
+
+struct SymbolBinaryEntry {
+    uint32_t name;
+    int32_t scope;
+    int32_t arraySize;
+    uint8_t identifierType;  // IdentifierKind
+    uint8_t dataType;        // DataType
+    uint8_t isArray;
+    uint8_t reserved;
+};
+
+struct SymbolBinaryParameterList {
+    uint32_t owner;
+    uint32_t first;
+    uint32_t count;
+};
+
+struct SymbolBinaryScope {
+    int32_t parent;
+    uint32_t owner;
+    uint32_t parameterList;
+};
+
+// builds the whole file in memory and writes it with one write call
+bool writeSymbolTableBinary(const SymbolTable& table, const std::string& path);
+
+// read-only view of a symboltable_<file>.bin; names point into the mapping
+class MappedSymbolTable {
+public:
+    bool open(const std::string& path);  // false if missing, truncated, a different version or byte order
+    void close();
+
+    uint32_t symbolCount() const { return header ? header->symbolCount : 0; }
+    uint32_t entryCount() const { return header ? header->entryCount : 0; }
+    uint32_t parameterListCount() const { return header ? header->parameterListCount : 0; }
+    uint32_t scopeCount() const { return header ? header->scopeCount : 0; }
+
+    const SymbolBinaryEntry& entry(uint32_t index) const { return entries[index]; }
+    std::string_view name(uint32_t index) const { return strings.get(entries[index].name); }
+    const SymbolBinaryParameterList& parameterList(uint32_t index) const { return parameterLists[index]; }
+    std::string_view parameterListOwner(uint32_t index) const { return strings.get(parameterLists[index].owner); }
+    const SymbolBinaryScope& scope(uint32_t id) const { return scopes[id]; }
+
+    SymbolTableEntry toEntry(uint32_t index) const;
+    void printTable(std::ostream& out) const;  // same text as SymbolTable::printTable
+
+private:
+    bool validate() const;
+
+    MappedFile file;
+    const SymbolBinaryHeader* header = nullptr;
+    const SymbolBinaryEntry* entries = nullptr;
+    const SymbolBinaryParameterList* parameterLists = nullptr;
+    const SymbolBinaryScope* scopes = nullptr;
+    BinaryStringTable strings;
+};
+
+#endif
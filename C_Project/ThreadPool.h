@@ -0,0 +1,38 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads fed from one FIFO queue
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned int threadCount = 0);  // 0 = one thread per core
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+    void wait();  // blocks until every submitted task has finished
+    unsigned int size() const { return static_cast<unsigned int>(workers.size()); }
+
+    static unsigned int defaultThreadCount();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable taskReady;
+    std::condition_variable allDone;
+    size_t activeTasks = 0;
+    bool stopping = false;
+};
+
+#endif
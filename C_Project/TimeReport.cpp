@@ -0,0 +1,156 @@
+#include "TimeReport.h"
+#include "CSTWriter.h"
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+
+const char* phaseName(Phase phase) {
+    switch (phase) {
+        case PHASE_STRIP: return "strip";
+        case PHASE_LEX: return "lex";
+        case PHASE_PARSE: return "parse";
+        case PHASE_SYMBOLS: return "symbols";
+        case PHASE_WRITE: return "write";
+        case PHASE_COUNT: break;
+    }
+    return "unknown";
+}
+
+double threadCpuSeconds() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    timespec now;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) == 0) return now.tv_sec + now.tv_nsec / 1e9;
+#endif
+    return processCpuSeconds();  // no per-thread clock: phases of parallel files overlap
+}
+
+double processCpuSeconds() {
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+double FileTiming::wallSeconds() const {
+    double total = 0;
+    for (const PhaseTime& phase : phases) total += phase.wallSeconds;
+    return total;
+}
+
+PhaseTimer::PhaseTimer(FileTiming* timing, Phase phase) : timing(timing), phase(phase) {
+    if (!timing) return;
+    wallStart = std::chrono::steady_clock::now();
+    cpuStart = threadCpuSeconds();
+}
+
+PhaseTimer::~PhaseTimer() {
+    if (!timing) return;
+    PhaseTime& time = timing->phases[phase];
+    time.wallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    time.cpuSeconds += threadCpuSeconds() - cpuStart;
+}
+
+// totals over all files
+struct ReportTotals {
+    uint64_t bytes = 0;
+    uint64_t tokens = 0;
+    uint64_t nodes = 0;
+    PhaseTime phases[PHASE_COUNT];
+    double phaseWallSeconds = 0;  // summed over threads, so more than the run's wall time when parallel
+};
+
+static ReportTotals totalsOf(const std::vector<FileTiming>& files) {
+    ReportTotals totals;
+    for (const FileTiming& file : files) {
+        totals.bytes += file.bytes;
+        totals.tokens += file.tokens;
+        totals.nodes += file.nodes;
+        for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+            totals.phases[phase].wallSeconds += file.phases[phase].wallSeconds;
+            totals.phases[phase].cpuSeconds += file.phases[phase].cpuSeconds;
+            totals.phaseWallSeconds += file.phases[phase].wallSeconds;
+        }
+    }
+    return totals;
+}
+
+static double perSecond(double amount, double seconds) {
+    return seconds > 0 ? amount / seconds : 0;
+}
+
+void TimeReport::printSummary(std::ostream& out) const {
+    const size_t SLOWEST_FILES = 5;
+    ReportTotals totals = totalsOf(files);
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2);
+
+    out << "time report: " << files.size() << " file(s), " << totals.bytes / 1e6 << " MB, " << threadCount
+        << " thread(s), " << wallSeconds * 1e3 << " ms wall, " << cpuSeconds * 1e3 << " ms CPU\n";
+    out << "  phase        wall ms      CPU ms   share\n";
+    for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+        const PhaseTime& time = totals.phases[phase];
+        out << "  " << std::left << std::setw(8) << phaseName(static_cast<Phase>(phase)) << std::right
+            << std::setw(12) << time.wallSeconds * 1e3 << std::setw(12) << time.cpuSeconds * 1e3 << std::setw(7)
+            << perSecond(100 * time.wallSeconds, totals.phaseWallSeconds) << "%\n";
+    }
+    out << "  throughput: " << perSecond(totals.bytes / 1e6, wallSeconds) << " MB/s, " << std::setprecision(0)
+        << perSecond(static_cast<double>(totals.tokens), wallSeconds) << " tokens/s, "
+        << perSecond(static_cast<double>(totals.nodes), wallSeconds) << " nodes/s\n";
+
+    std::vector<const FileTiming*> slowest;
+    for (const FileTiming& file : files) slowest.push_back(&file);
+    std::sort(slowest.begin(), slowest.end(), [](const FileTiming* a, const FileTiming* b) {
+        return a->wallSeconds() > b->wallSeconds();
+    });
+    if (slowest.size() > SLOWEST_FILES) slowest.resize(SLOWEST_FILES);
+    out << std::setprecision(2);
+    if (!slowest.empty()) out << "  slowest files (wall ms):\n";
+    for (const FileTiming* file : slowest) {
+        out << std::setw(12) << file->wallSeconds() * 1e3 << "  " << file->name << "\n";
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+static void writePhasesJson(std::ostream& out, const PhaseTime* phases) {
+    out << "{";
+    for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+        out << (phase ? ", " : "") << "\"" << phaseName(static_cast<Phase>(phase)) << "\": {\"wall_seconds\": "
+            << phases[phase].wallSeconds << ", \"cpu_seconds\": " << phases[phase].cpuSeconds << "}";
+    }
+    out << "}";
+}
+
+// bump format when a field changes meaning, so tools comparing reports can tell
+void TimeReport::writeJson(std::ostream& out) const {
+    ReportTotals totals = totalsOf(files);
+    std::streamsize precision = out.precision();
+    out << std::setprecision(9);
+
+    out << "{\n";
+    out << "  \"format\": 1,\n";
+    out << "  \"threads\": " << threadCount << ",\n";
+    out << "  \"wall_seconds\": " << wallSeconds << ",\n";
+    out << "  \"cpu_seconds\": " << cpuSeconds << ",\n";
+    out << "  \"files\": " << files.size() << ",\n";
+    out << "  \"bytes\": " << totals.bytes << ",\n";
+    out << "  \"tokens\": " << totals.tokens << ",\n";
+    out << "  \"nodes\": " << totals.nodes << ",\n";
+    out << "  \"bytes_per_second\": " << perSecond(static_cast<double>(totals.bytes), wallSeconds) << ",\n";
+    out << "  \"tokens_per_second\": " << perSecond(static_cast<double>(totals.tokens), wallSeconds) << ",\n";
+    out << "  \"nodes_per_second\": " << perSecond(static_cast<double>(totals.nodes), wallSeconds) << ",\n";
+    out << "  \"phases\": ";
+    writePhasesJson(out, totals.phases);
+    out << ",\n  \"per_file\": [";
+    for (size_t i = 0; i < files.size(); ++i) {
+        const FileTiming& file = files[i];
+        out << (i ? ",\n    " : "\n    ") << "{\"name\": ";
+        writeJsonString(out, file.name);
+        out << ", \"bytes\": " << file.bytes << ", \"tokens\": " << file.tokens << ", \"nodes\": " << file.nodes
+            << ", \"wall_seconds\": " << file.wallSeconds() << ", \"phases\": ";
+        writePhasesJson(out, file.phases);
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+
+    out.precision(precision);
+}
@@ -0,0 +1,72 @@
+#ifndef TIME_REPORT_H
+#define TIME_REPORT_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// --time-report: wall and CPU time per pipeline phase, per file and for the whole run
+enum Phase {
+    PHASE_STRIP,    // reading the input and removing comments
+    PHASE_LEX,      // tokenizer
+    PHASE_PARSE,    // parser, which also builds the symbol table as it goes
+    PHASE_SYMBOLS,  // name resolution, type checking and frame layout (--resolve/--typecheck/--frames)
+    PHASE_WRITE,    // every output file
+    PHASE_COUNT
+};
+
+const char* phaseName(Phase phase);
+
+struct PhaseTime {
+    double wallSeconds = 0;
+    double cpuSeconds = 0;  // of the thread that ran the phase
+};
+
+struct FileTiming {
+    std::string name;
+    uint64_t bytes = 0;   // of the input
+    uint64_t tokens = 0;
+    uint64_t nodes = 0;   // CST nodes
+    PhaseTime phases[PHASE_COUNT];
+
+    double wallSeconds() const;
+};
+
+// adds the time from construction to destruction to one phase of timing. a null timing
+// makes it do nothing, so the pipeline can always create one
+class PhaseTimer {
+public:
+    PhaseTimer(FileTiming* timing, Phase phase);
+    ~PhaseTimer();
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    FileTiming* timing;
+    Phase phase;
+    std::chrono::steady_clock::time_point wallStart;
+    double cpuStart = 0;
+};
+
+// the timings of one run. files[i] belongs to input i and is only written by the thread
+// processing that input, so no locking is needed
+struct TimeReport {
+    std::vector<FileTiming> files;
+    unsigned int threadCount = 1;
+    double wallSeconds = 0;  // of the whole run, start to finish
+    double cpuSeconds = 0;   // of the whole process over the run, all threads
+
+    // phase totals and throughput, then the slowest files
+    void printSummary(std::ostream& out) const;
+    // everything, per file included, for comparing runs across versions
+    void writeJson(std::ostream& out) const;
+};
+
+// CPU time used so far by the calling thread / the whole process, in seconds
+double threadCpuSeconds();
+double processCpuSeconds();
+
+#endif
@@ -2,11 +2,16 @@
 #include "Tokenizer.h"
 
 TokenStream::TokenStream(const std::vector<Token>& tokens)
-    : tokens(tokens), currentIndex(0) {}
+    : ownedTokens(tokens), tokens(&ownedTokens), currentIndex(0),
+      windowEnd(ownedTokens.size()), consumedPastEnd(false) {}
+
+TokenStream::TokenStream(const std::vector<Token>& tokens, size_t begin, size_t end)
+    : tokens(&tokens), currentIndex(begin), windowEnd(end), consumedPastEnd(false) {}
 
 Token TokenStream::getNextToken() {
-    if (currentIndex < tokens.size()) {
-        return tokens[currentIndex++];
+    if (currentIndex < tokens->size()) {
+        if (currentIndex >= windowEnd) consumedPastEnd = true;
+        return (*tokens)[currentIndex++];
     }
     return {TOKEN_UNKNOWN, "EOF", -1};  // return a special token indicating end of tokens
 }
@@ -15,8 +20,12 @@ void TokenStream::rewind() {
     if (currentIndex > 0) currentIndex--;
 }
 
+void TokenStream::skipToEnd() {
+    currentIndex = tokens->size();
+}
+
 bool TokenStream::hasMoreTokens() const {
-    return currentIndex < tokens.size();
+    return currentIndex < tokens->size();
 }
 
 int TokenStream::getCurrentIndex() const {
@@ -24,8 +33,8 @@ int TokenStream::getCurrentIndex() const {
 }
 
 Token TokenStream::peekNextToken() {
-    if (currentIndex < tokens.size()) {
-        return tokens[currentIndex]; // return the current token without advancing the index
+    if (currentIndex < tokens->size()) {
+        return (*tokens)[currentIndex]; // return the current token without advancing the index
     }
     return {TOKEN_UNKNOWN, "EOF", -1};  // return a special token indicating end of tokens
 }
@@ -6,17 +6,29 @@
 
 class TokenStream {
 private:
-    std::vector<Token> tokens;
+    std::vector<Token> ownedTokens;      // empty when this stream is a window over another list
+    const std::vector<Token>* tokens;
     size_t currentIndex;
+    size_t windowEnd;
+    bool consumedPastEnd;
 
 public:
     TokenStream(const std::vector<Token>& tokens);
+    // window [begin, end) over a token list owned by the caller. tokens after `end` stay
+    // visible so parsing behaves exactly as it would on the whole list, but consuming
+    // one of them is recorded (see consumedPastWindow)
+    TokenStream(const std::vector<Token>& tokens, size_t begin, size_t end);
+    TokenStream(const TokenStream&) = delete;
+    TokenStream& operator=(const TokenStream&) = delete;
 
     Token getNextToken();
     void rewind();
     bool hasMoreTokens() const;
     int getCurrentIndex() const;
     Token peekNextToken();
+    void skipToEnd();
+    bool consumedPastWindow() const { return consumedPastEnd; }
+    const std::vector<Token>& getTokens() const { return *tokens; }
 };
 
 #endif
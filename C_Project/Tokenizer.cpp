@@ -1,4 +1,5 @@
 #include "Tokenizer.h"
+#include "Trace.h"
 #include <cctype>
 #include <unordered_set>
 #include <iostream>
@@ -6,16 +7,27 @@
 #include "ErrorHandler.h"  
 
 
-Tokenizer::Tokenizer(const std::string& filename, const std::string& outputFile, int startLine)
-    : outputFilename(outputFile), lineNumber(startLine) {
-    inputFile.open(filename);
-    if (!inputFile) {
-        errorHandler.addError(0, "Unable to open file: " + filename);
+Tokenizer::Tokenizer(const std::string& filename, const std::string& outputFile, int startLine,
+                     ErrorHandler& errorHandler)
+    : inputFile(file), outputFilename(outputFile), lineNumber(startLine), errorHandler(errorHandler) {
+    file.open(filename);
+    if (!file) {
+        errorHandler.report(DIAG_CANNOT_OPEN_FILE, 0, filename);
         return;
     }
     declaredIdentifiers.clear();
 }
 
+Tokenizer::Tokenizer(std::istream& input, int startLine, ErrorHandler& errorHandler)
+    : inputFile(input), lineNumber(startLine), errorHandler(errorHandler) {}
+
+// stops tokenizing after an error: nothing more is read, and the stripped file the
+// tokens came from (if any) is deleted
+void Tokenizer::abandonInput() {
+    inputFile.setstate(std::ios::failbit);
+    if (!outputFilename.empty()) std::remove(outputFilename.c_str());
+}
+
 void Tokenizer::addToken(TokenType type, const std::string& value, int tokenLine) {
     Token token(type, value, tokenLine);  // properly initialize with constructor
     tokens.push_back(token);
@@ -47,11 +59,8 @@ void Tokenizer::processIdentifierOrKeyword(char firstChar) {
 
     //  reject identifiers that start with a digit and aren't declared
     if (std::isdigit(value[0]) && declaredIdentifiers.find(value) == declaredIdentifiers.end()) {
-        errorHandler.addError(lineNumber, "Syntax error: invalid identifier '" + value + "'");
-        std::remove(outputFilename.c_str());  
-
-        inputFile.close();
-        std::remove(outputFilename.c_str()); //  delete the incomplete output file
+        errorHandler.report(DIAG_INVALID_IDENTIFIER, lineNumber, value);
+        abandonInput();
         return; // stop processing
     }
 
@@ -105,10 +114,9 @@ void Tokenizer::processNumber(char firstChar) {
     }
 
     if (invalid) {
-        errorHandler.addError(tokenLine, "Syntax error: invalid integer '" + value + "'");
+        errorHandler.report(DIAG_INVALID_INTEGER, tokenLine, value);
         tokens.clear();
-        inputFile.close();
-        std::remove(outputFilename.c_str()); //  delete the incomplete output file
+        abandonInput();
         return; // stop processing
     }
 
@@ -174,7 +182,7 @@ void Tokenizer::processStringLiteral(char delimiter) {
                 return;
             }
         }
-        errorHandler.addError(tokenLine, "Syntax error: unterminated character literal.");
+        errorHandler.report(DIAG_UNTERMINATED_CHAR, tokenLine);
         return;
     }
 
@@ -218,9 +226,8 @@ void Tokenizer::processStringLiteral(char delimiter) {
     }
 
     if (unterminated) {
-        errorHandler.addError(tokenLine, "Syntax error: unterminated string literal starting here.");
-        inputFile.close();
-        std::remove(outputFilename.c_str()); // delete the incomplete output file
+        errorHandler.report(DIAG_UNTERMINATED_STRING, tokenLine);
+        abandonInput();
         return;
     }
 
@@ -259,20 +266,19 @@ void Tokenizer::processCharLiteral() {
         }
 
         if (c == '\n') {              // newline before closing quote
-            errorHandler.addError(tokenLine,
-                "Syntax error: unterminated character literal.");
+            errorHandler.report(DIAG_UNTERMINATED_CHAR, tokenLine);
             return;
         }
     }
 
     // fell off the end of file without a closing quote
-    errorHandler.addError(tokenLine,
-        "Syntax error: unterminated character literal at end of file.");
+    errorHandler.report(DIAG_UNTERMINATED_CHAR_AT_EOF, tokenLine);
 }
 
 
 
 void Tokenizer::tokenize() {
+    TRACE_SCOPE("Tokenizer::tokenize");
     tokens.clear();  // ensure fresh token list
 
     char c;
@@ -321,17 +327,11 @@ void Tokenizer::tokenize() {
             processUnknown(c);
         }
     }
-
-    // ensure errors are logged to file
-    if (errorHandler.hasErrors()) {
-        errorHandler.printErrors();
-        
-    }
 }
 
 void Tokenizer::processUnknown(char c) {
-    std::string value(1, c);  // convert character to string
-    errorHandler.addError(lineNumber, "Unknown token encountered: '" + value + "'");
+    char value[2] = {c, '\0'};
+    errorHandler.report(DIAG_UNKNOWN_TOKEN, lineNumber, value);
 }
 
 
@@ -70,18 +70,21 @@ struct Token {
 
 class Tokenizer {
 public:
-    Tokenizer(const std::string& filename, const std::string& outputFile, int startLine);
+    Tokenizer(const std::string& filename, const std::string& outputFile, int startLine, ErrorHandler& errorHandler);
+    Tokenizer(std::istream& input, int startLine, ErrorHandler& errorHandler);  // reads the caller's stream
     void tokenize();
     void printTokens() const;
     std::vector<Token> getTokens() const { return tokens; }
     
 private:
-    std::ifstream inputFile;
+    std::ifstream file;       // opened by the filename constructor
+    std::istream& inputFile;  // what is tokenized: file or the caller's stream
     std::string outputFilename;
     std::vector<Token> tokens;
     std::unordered_set<std::string> declaredIdentifiers; // Track declared variables instead of just giving integer syntax error
 
     
+    void abandonInput();
     void processUnknown(char c);
     void addToken(TokenType type, const std::string& value, int lineNumber);
     void skipWhitespace();
@@ -93,7 +96,7 @@ private:
     void processCharLiteral();
     int lineNumber;  // Line number counter for the tokenizer
 
-    ErrorHandler errorHandler;
+    ErrorHandler& errorHandler;  // the unit's diagnostics, owned by the caller
 };
 
 
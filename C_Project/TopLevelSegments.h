@@ -0,0 +1,32 @@
+#ifndef TOP_LEVEL_SEGMENTS_H
+#define TOP_LEVEL_SEGMENTS_H
+
+#include "CSTNode.h"
+#include "ErrorHandler.h"
+#include "SymbolTable.h"
+#include "Tokenizer.h"
+#include <vector>
+
+// a top-level procedure/function definition (keyword through the '}' matching its
+// body's '{') or a run of top-level statements between two definitions
+struct TopLevelSegment {
+    size_t begin;
+    size_t end;  // one past the last token
+    bool isDefinition;
+};
+
+// everything parsing one segment on its own produced (see Parser::parseSegment)
+struct SegmentResult {
+    std::vector<CSTNode*> nodes;
+    SymbolTable table;
+    size_t firstEntry = 0;  // entries before this index were the seeded globals
+    ErrorHandler errors;
+    bool matchesSerial = false;
+};
+
+// splits tokens[begin..] into segments. returns false when the layout is not clean
+// enough to split safely (unbalanced braces, a definition inside a body, a repeated
+// definition name); callers then fall back to Parser::parseProgram
+bool findTopLevelSegments(const std::vector<Token>& tokens, size_t begin, std::vector<TopLevelSegment>& segments);
+
+#endif
@@ -0,0 +1,100 @@
+#include "Trace.h"
+
+#ifdef ENABLE_TRACING
+
+#include "CSTWriter.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    uint64_t start;     // nanoseconds since the trace began
+    uint64_t duration;
+};
+
+// the events of one thread. only that thread appends to it, so recording takes no lock;
+// the buffers are read at exit, once the worker threads have been joined
+struct ThreadBuffer {
+    uint32_t thread;
+    std::vector<TraceEvent> events;
+};
+
+class TraceSession {
+public:
+    TraceSession() : origin(std::chrono::steady_clock::now()) {}
+    ~TraceSession() { write(); }
+
+    uint64_t now() const {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count());
+    }
+
+    // once per thread, on its first event
+    ThreadBuffer* addThread() {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers.emplace_back(new ThreadBuffer());
+        buffers.back()->thread = static_cast<uint32_t>(buffers.size());
+        buffers.back()->events.reserve(4096);
+        return buffers.back().get();
+    }
+
+private:
+    // Chrome trace event format: complete ("X") events, times in microseconds
+    void write() {
+        const char* path = std::getenv("TOKENIZER_TRACE");
+        std::ofstream out(path && *path ? path : "trace.json");
+        if (!out) return;
+
+        out << "{\"traceEvents\": [\n";
+        out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"tokenizer\"}}";
+        for (const auto& buffer : buffers) {
+            out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->thread
+                << ", \"args\": {\"name\": \"thread " << buffer->thread << "\"}}";
+            for (const TraceEvent& event : buffer->events) {
+                out << ",\n{\"name\": ";
+                writeJsonString(out, event.name);
+                out << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->thread << ", \"ts\": "
+                    << event.start / 1000 << "." << microsecondFraction(event.start) << ", \"dur\": "
+                    << event.duration / 1000 << "." << microsecondFraction(event.duration) << "}";
+            }
+        }
+        out << "\n], \"displayTimeUnit\": \"ms\"}\n";
+    }
+
+    // the three digits after the point of nanoseconds / 1000
+    static std::string microsecondFraction(uint64_t nanoseconds) {
+        std::string digits = std::to_string(nanoseconds % 1000);
+        return std::string(3 - digits.size(), '0') + digits;
+    }
+
+    std::chrono::steady_clock::time_point origin;
+    std::mutex mutex;  // only for addThread
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+TraceSession& session() {
+    static TraceSession instance;
+    return instance;
+}
+
+thread_local ThreadBuffer* threadBuffer = nullptr;
+
+}
+
+TraceScope::TraceScope(const char* name) : name(name), start(session().now()) {}
+
+TraceScope::~TraceScope() {
+    TraceSession& trace = session();
+    uint64_t end = trace.now();
+    if (!threadBuffer) threadBuffer = trace.addThread();
+    threadBuffer->events.push_back({name, start, end - start});
+}
+
+#endif
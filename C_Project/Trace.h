@@ -0,0 +1,36 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+// scoped markers for a Chrome/Perfetto timeline (chrome://tracing or ui.perfetto.dev).
+// TRACE_SCOPE("name") records the time from that line to the end of the enclosing block as
+// one event of the calling thread. only a "make trace" build (-DENABLE_TRACING) records
+// anything; otherwise the macro expands to nothing. the events are written to trace.json,
+// or the file $TOKENIZER_TRACE names, when the program exits
+#ifdef ENABLE_TRACING
+
+#include <cstdint>
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name);  // kept as a pointer, so a string literal
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+
+#endif
+
+#endif
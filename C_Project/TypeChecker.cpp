@@ -0,0 +1,271 @@
+#include "TypeChecker.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <vector>
+
+static bool isNumeric(DataType type) {
+    return type == TYPE_INT || type == TYPE_CHAR || type == TYPE_FLOAT || type == TYPE_DOUBLE;
+}
+
+static bool isIntegral(DataType type) {
+    return type == TYPE_INT || type == TYPE_CHAR;
+}
+
+// usable as a condition: C-style, ints count as truth values too
+static bool isScalar(DataType type) {
+    return type == TYPE_BOOL || isNumeric(type);
+}
+
+// one character or one escape ('a', '\n', '\x0') between single quotes
+static bool isCharLiteral(const std::string& text) {
+    if (text.size() < 3) return false;
+    std::string body = text.substr(1, text.size() - 2);
+    if (body.size() == 1) return true;
+    return body[0] == '\\' && (body.size() == 2 || (body[1] == 'x' && body.size() <= 4));
+}
+
+TypeChecker::TypeChecker(const SymbolTable& table, const NameResolver& resolver, ErrorHandler& errors)
+    : table(table), resolver(resolver), errors(errors), typedNodes(0) {}
+
+std::string TypeChecker::typeName(ExprType type) {
+    return std::string(dataTypeToString(type.base)) + (type.isArray ? "[]" : "");
+}
+
+// numbers mix freely (as in C), bool only takes bool, and arrays only take an array of
+// the same element type (a string literal is a char array)
+bool TypeChecker::isAssignable(ExprType target, ExprType value) {
+    if (target.base == TYPE_UNKNOWN || value.base == TYPE_UNKNOWN) return true;  // already reported
+    if (target.isArray || value.isArray) return target.isArray && value.isArray && target.base == value.base;
+    if (isNumeric(target.base)) return isNumeric(value.base);
+    return target.base == value.base;
+}
+
+TypeChecker::ExprType TypeChecker::operandType(const CSTNode* node) const {
+    const std::string& text = node->value;
+    if (text.empty()) return {TYPE_UNKNOWN, false};
+    if (text[0] == '"') return {TYPE_CHAR, true};
+    if (text[0] == '\'') return {TYPE_CHAR, !isCharLiteral(text)};  // 'Robert\x0' is a string
+    if (std::isdigit(static_cast<unsigned char>(text[0])) || text[0] == '-') return {TYPE_INT, false};
+    if (text == "TRUE" || text == "FALSE") return {TYPE_BOOL, false};
+
+    if (node->symbolId < 0) return {TYPE_UNKNOWN, false};  // undeclared, reported by NameResolver
+    const SymbolTableEntry* entry = resolver.getSymbols()[node->symbolId].entry;
+    return {entry->dataType, entry->isArray};
+}
+
+TypeChecker::ExprType TypeChecker::operatorType(const CSTNode* node) {
+    const std::string& op = node->value;
+    const CSTNode* left = node->leftChild;
+    const CSTNode* right = left ? left->rightSibling : nullptr;
+    if (!left) return {TYPE_UNKNOWN, false};
+
+    ExprType a = typeOf(left);
+    if (!right && op == "-") {  // unary minus: numeric, char promotes to int like in arithmetic
+        if (a.base == TYPE_UNKNOWN) return {TYPE_UNKNOWN, false};
+        if (a.isArray || !isNumeric(a.base)) {
+            errors.report(DIAG_UNARY_OPERAND, node->lineNumber, op, typeName(a));
+            return {TYPE_UNKNOWN, false};  // reported once, not again by whatever uses it
+        }
+        return {a.base == TYPE_CHAR ? TYPE_INT : a.base, false};
+    }
+    if (!right) {  // unary '!'
+        if (a.base != TYPE_UNKNOWN && (a.isArray || !isScalar(a.base))) {
+            errors.report(DIAG_UNARY_OPERAND, node->lineNumber, op, typeName(a));
+        }
+        return {TYPE_BOOL, false};
+    }
+
+    ExprType b = typeOf(right);
+    bool logical = op == "&&" || op == "||";
+    bool equality = op == "==" || op == "!=";
+    bool relational = op == "<" || op == ">" || op == "<=" || op == ">=";
+
+    if (a.base != TYPE_UNKNOWN && b.base != TYPE_UNKNOWN) {
+        bool ok;
+        if (a.isArray || b.isArray) {
+            ok = false;
+        } else if (logical) {
+            ok = isScalar(a.base) && isScalar(b.base);
+        } else if (equality) {
+            ok = (isNumeric(a.base) && isNumeric(b.base)) || a.base == b.base;
+        } else {
+            ok = isNumeric(a.base) && isNumeric(b.base);
+        }
+        if (!ok) {
+            errors.report(DIAG_BINARY_OPERANDS, node->lineNumber, op, typeName(a), typeName(b));
+        }
+    }
+
+    if (logical || equality || relational) return {TYPE_BOOL, false};
+    if (a.base == TYPE_DOUBLE || b.base == TYPE_DOUBLE) return {TYPE_DOUBLE, false};
+    if (a.base == TYPE_FLOAT || b.base == TYPE_FLOAT) return {TYPE_FLOAT, false};
+    if (a.base == TYPE_UNKNOWN || b.base == TYPE_UNKNOWN) return {TYPE_UNKNOWN, false};
+    return {TYPE_INT, false};  // char arithmetic promotes to int
+}
+
+TypeChecker::ExprType TypeChecker::arrayAccessType(const CSTNode* node) {
+    if (node->leftChild) {
+        ExprType index = typeOf(node->leftChild);
+        if (index.base != TYPE_UNKNOWN && (index.isArray || !isIntegral(index.base))) {
+            errors.report(DIAG_INDEX_NOT_INT, node->lineNumber, node->value, typeName(index));
+        }
+    }
+
+    if (node->symbolId < 0) return {TYPE_UNKNOWN, false};
+    const SymbolTableEntry* entry = resolver.getSymbols()[node->symbolId].entry;
+    if (!entry->isArray) {
+        errors.report(DIAG_NOT_AN_ARRAY, node->lineNumber, node->value);
+        return {TYPE_UNKNOWN, false};
+    }
+    return {entry->dataType, false};
+}
+
+TypeChecker::ExprType TypeChecker::callType(const CSTNode* node, bool hasArguments) {
+    if (node->symbolId < 0) return {TYPE_UNKNOWN, false};  // builtin or undeclared
+    const ResolvedSymbol& function = resolver.getSymbols()[node->symbolId];
+    if (!hasArguments) return {function.entry->dataType, false};
+
+    const std::vector<SymbolTableEntry>* params = table.getParameterList(function.name);
+    size_t expected = params ? params->size() : 0;
+    size_t given = 0;
+    for (const CSTNode* arg = node->leftChild; arg; arg = arg->rightSibling) {
+        if (given < expected) {
+            const SymbolTableEntry& param = (*params)[given];
+            ExprType argType = typeOf(arg);
+            if (!isAssignable({param.dataType, param.isArray}, argType)) {
+                errors.report(DIAG_ARGUMENT_TYPE, arg->lineNumber, given + 1, function.name,
+                              typeName({param.dataType, param.isArray}), typeName(argType));
+            }
+        }
+        given++;
+    }
+    if (given != expected) {
+        errors.report(DIAG_ARGUMENT_COUNT, node->lineNumber, function.name, expected, given);
+    }
+
+    return {function.entry->dataType, false};
+}
+
+void TypeChecker::checkAssignment(const CSTNode* node) {
+    const CSTNode* target = node->leftChild;
+    ExprType targetType;
+    const CSTNode* value;
+
+    if (node->value == "[]") {  // children: ArrayAccess, value
+        if (!target) return;
+        targetType = typeOf(target);
+        value = target->rightSibling;
+    } else {
+        if (node->symbolId < 0) return;
+        const SymbolTableEntry* entry = resolver.getSymbols()[node->symbolId].entry;
+        targetType = {entry->dataType, entry->isArray};
+        value = target;
+    }
+    if (!value) return;
+
+    ExprType valueType = typeOf(value);
+    if (!isAssignable(targetType, valueType)) {
+        std::string name = node->value == "[]" ? target->value + "[]" : node->value;
+        errors.report(DIAG_ASSIGN_TYPE, node->lineNumber, typeName(valueType), name, typeName(targetType));
+    }
+}
+
+void TypeChecker::checkReturn(const CSTNode* node, int function) {
+    if (function < 0 || !node->leftChild) return;
+    const ResolvedSymbol& owner = resolver.getSymbols()[function];
+    ExprType valueType = typeOf(node->leftChild);
+
+    if (owner.entry->identifierType == IDENTIFIER_PROCEDURE) {
+        errors.report(DIAG_PROCEDURE_RETURNS_VALUE, node->lineNumber, owner.name);
+    } else if (!isAssignable({owner.entry->dataType, false}, valueType)) {
+        errors.report(DIAG_RETURN_TYPE, node->lineNumber, owner.name, dataTypeToString(owner.entry->dataType),
+                      typeName(valueType));
+    }
+}
+
+void TypeChecker::checkCondition(const CSTNode* condition) {
+    if (!condition) return;
+    ExprType type = typeOf(condition);
+    if (type.base != TYPE_UNKNOWN && (type.isArray || !isScalar(type.base))) {
+        errors.report(DIAG_CONDITION_TYPE, condition->lineNumber, typeName(type));
+    }
+}
+
+// runs after the node's children, so their types are already cached
+void TypeChecker::computeType(CSTNode* node, int function, bool inExpression) {
+    ExprType type = {TYPE_UNKNOWN, false};
+    bool isExpression = true;
+
+    if (node->name == "Operand") {
+        type = operandType(node);
+    } else if (node->name == "EscapeSequence") {
+        type = {TYPE_CHAR, false};
+    } else if (node->name == "Operator") {
+        type = operatorType(node);
+    } else if (node->name == "ArrayAccess") {
+        type = arrayAccessType(node);
+    } else if (node->name == "FunctionCall") {
+        type = callType(node, inExpression);
+    } else {
+        isExpression = false;
+        if (node->name == "Assignment") {
+            checkAssignment(node);
+        } else if (node->name == "Return") {
+            checkReturn(node, function);
+        } else if (node->name == "IfStatement" || node->name == "WhileStatement") {
+            checkCondition(node->leftChild);
+        } else if (node->name == "ForStatement" && node->leftChild) {
+            checkCondition(node->leftChild->rightSibling);  // init, condition, step, body
+        }
+    }
+
+    if (isExpression) {
+        node->type = type.base;
+        node->typeIsArray = type.isArray;
+        typedNodes++;
+    }
+}
+
+void TypeChecker::check(CSTNode* root) {
+    TRACE_SCOPE("TypeChecker::check");
+    struct Pending {
+        CSTNode* node;
+        int function;       // symbol id of the enclosing procedure/function, -1 at top level
+        bool inExpression;  // false for statements
+        bool expanded;      // children already pushed; type it on the next visit
+    };
+    std::vector<Pending> pending;
+    for (CSTNode* node = root; node; node = node->rightSibling) pending.push_back({node, -1, false, false});
+    std::reverse(pending.begin(), pending.end());
+
+    while (!pending.empty()) {
+        Pending current = pending.back();
+        pending.pop_back();
+        if (current.expanded) {
+            computeType(current.node, current.function, current.inExpression);
+            continue;
+        }
+
+        CSTNode* node = current.node;
+        if (node->name == "Declaration" || node->name == "ParameterType") continue;
+
+        int function = current.function;
+        if (node->name == "Procedure" || node->name == "Function") function = resolver.findFunction(node->value);
+
+        // children of statement containers are statements, except the loop/if condition
+        bool container = node->name == "Program" || node->name == "Procedure" || node->name == "Function" ||
+                         node->name == "IfStatement" || node->name == "ElseStatement" ||
+                         node->name == "WhileStatement" || node->name == "ForStatement";
+        int conditionIndex = node->name == "ForStatement" ? 1 :
+                             (node->name == "IfStatement" || node->name == "WhileStatement") ? 0 : -1;
+
+        pending.push_back({node, function, current.inExpression, true});
+        size_t firstChild = pending.size();
+        int index = 0;
+        for (CSTNode* child = node->leftChild; child; child = child->rightSibling, ++index) {
+            pending.push_back({child, function, !container || index == conditionIndex, false});
+        }
+        std::reverse(pending.begin() + firstChild, pending.end());  // errors come out in source order
+    }
+}
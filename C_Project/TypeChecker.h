@@ -0,0 +1,49 @@
+#ifndef TYPE_CHECKER_H
+#define TYPE_CHECKER_H
+
+#include "CSTNode.h"
+#include "ErrorHandler.h"
+#include "NameResolver.h"
+#include "SymbolTable.h"
+#include <string>
+
+// checks operand types of operators, array indices, assignments, returns, conditions
+// and call arguments (count and types, against the parameter lists). every expression
+// node gets its type cached in CSTNode::type/typeIsArray, so later stages can pick
+// type-specific operations without re-deriving them. needs a tree annotated by the
+// given NameResolver. calls written as statements lose their arguments in the CST, so
+// only calls inside expressions get their arguments checked
+class TypeChecker {
+public:
+    TypeChecker(const SymbolTable& table, const NameResolver& resolver, ErrorHandler& errors);
+
+    void check(CSTNode* root);  // root and its right siblings
+
+    size_t getTypedNodeCount() const { return typedNodes; }
+
+private:
+    struct ExprType {
+        DataType base;
+        bool isArray;
+    };
+
+    void computeType(CSTNode* node, int function, bool inExpression);
+    ExprType operandType(const CSTNode* node) const;
+    ExprType operatorType(const CSTNode* node);
+    ExprType arrayAccessType(const CSTNode* node);
+    ExprType callType(const CSTNode* node, bool hasArguments);
+    void checkAssignment(const CSTNode* node);
+    void checkReturn(const CSTNode* node, int function);
+    void checkCondition(const CSTNode* condition);
+
+    static ExprType typeOf(const CSTNode* node) { return {node->type, node->typeIsArray}; }
+    static bool isAssignable(ExprType target, ExprType value);
+    static std::string typeName(ExprType type);
+
+    const SymbolTable& table;
+    const NameResolver& resolver;
+    ErrorHandler& errors;
+    size_t typedNodes;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#include "CompileProtocol.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace fs = std::filesystem;
+
+// tokenizer-client: sends its command line to a running "tokenizer --serve" and acts on the
+// answer as the tokenizer itself would: errors go to stderr and errors.txt, outputs land in
+// the output directory. saves starting a process per file when there are thousands of them
+static void printClientUsage(const char* program, std::ostream& out) {
+    out << "usage: " << program << " [--socket=<path>] [--stdin=<name>] [tokenizer options] [inputs]...\n"
+        << "\n"
+        << "runs a tokenizer command line on the server started with \"tokenizer --serve\".\n"
+        << "  --socket=<path>   the server's socket (default " << defaultSocketPath() << ")\n"
+        << "  --stdin=<name>    send the source read from stdin as file <name> instead of naming inputs\n"
+        << "every other argument is passed on; see \"tokenizer --help\".\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string socketPath = defaultSocketPath();
+    CompileRequest request;
+    std::string stdinName;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            printClientUsage(argv[0], std::cout);
+            return 0;
+        } else if (std::strncmp(argv[i], "--socket=", 9) == 0) {
+            socketPath = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--stdin=", 8) == 0) {
+            stdinName = argv[i] + 8;
+        } else {
+            request.arguments.push_back(argv[i]);
+        }
+    }
+
+    std::error_code error;
+    request.workingDirectory = fs::current_path(error).string();
+    if (!stdinName.empty()) {
+        InlineSource source;
+        source.name = stdinName;
+        source.text.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        request.sources.push_back(std::move(source));
+    }
+
+    int connection = connectToServer(socketPath);
+    if (connection < 0) {
+        std::cerr << "cannot connect to " << socketPath << " (is \"tokenizer --serve\" running?)" << std::endl;
+        return 1;
+    }
+    CompileResponse response;
+    bool answered = sendRequest(connection, request) && receiveResponse(connection, response);
+    closeConnection(connection);
+    if (!answered) {
+        std::cerr << "no answer from the server on " << socketPath << std::endl;
+        return 1;
+    }
+
+    if (!response.outputs.empty()) fs::create_directories(response.outputDirectory, error);
+    for (const ReturnedOutput& output : response.outputs) {
+        std::ofstream file(response.outputDirectory + "/" + output.name, std::ios::binary);
+        if (!file.write(output.bytes.data(), output.bytes.size())) {
+            std::cerr << "Error: Unable to create output file " << response.outputDirectory << "/" << output.name << "\n";
+        }
+    }
+    std::cerr << response.terminal;
+    if (!response.log.empty()) {
+        std::ofstream log("errors.txt", std::ios::app);  // like the tokenizer, only opened when there is something to log
+        if (log) log << response.log;
+        else std::cerr << "[ERROR] Unable to open error log file: errors.txt\n";
+    }
+    return response.status;
+}
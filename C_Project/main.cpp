@@ -3,14 +3,42 @@
 #include "ErrorHandler.h"
 #include "TokenStream.h"
 #include "Parser.h"
+#include "AST.h"
 #include <iostream>
 #include <vector>
 #include <filesystem>
 #include <fstream>
+#include <sstream>
 #include "SymbolTable.h"
+#include "CSTWriter.h"
+#include "CSTBinary.h"
+#include "NameResolver.h"
+#include "FrameLayout.h"
+#include "TypeChecker.h"
+#include "MultiFileProgram.h"
+#include "SymbolTableBinary.h"
+#include "ThreadPool.h"
+#include "CommandLine.h"
+#include "BuildCache.h"
+#include "MappedFile.h"
+#include "ContentHash.h"
+#include "IncrementalParser.h"
+#include "FileWatcher.h"
+#include "CompileProtocol.h"
+#include "TimeReport.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
 
 namespace fs = std::filesystem;
-extern ErrorHandler errorHandler;
 
 std::string tokenTypeToString(TokenType type) {
     switch (type) {
@@ -52,163 +80,824 @@ std::string tokenTypeToString(TokenType type) {
     }
 }
 
-void printCST(CSTNode* node, int depth = 0) {
-    if (!node) return;
-    for (int i = 0; i < depth * 4; ++i) std::cout << " "; 
+// both print the node, its children and its right siblings; iterative (see emitCST)
+void printCST(CSTNode* node, CSTOutputFormat format = CST_FORMAT_TEXT) {
+    writeCST(node, std::cout, format);
+}
 
-    if (node->name == "Symbol") {
-        std::cout << '"' << node->value << '"' << std::endl;  // print symbol nodes directly (e.g., "(", ")", "{", "}")
-    } else {
-        std::cout << node->name << " (" << node->value << ") [Line: " << node->lineNumber << "]" << std::endl;
-    }
+void writeCSTToFile(CSTNode* node, std::ofstream& out, CSTOutputFormat format = CST_FORMAT_TEXT) {
+    writeCST(node, out, format);
+}
 
-    if (node->leftChild) printCST(node->leftChild, depth + 1);
-    if (node->rightSibling) printCST(node->rightSibling, depth);
+// ast_<file> (--ast): the AST lowered from a finished CST, headed by both trees' node counts
+void writeASTFile(const CSTNode* cstRoot, const ASTProgram* ast, const std::string& name, const std::string& path) {
+    std::ofstream astFile(path);
+    if (!astFile) return;
+    astFile << "AST for file: " << name << " (" << countASTNodes(ast) << " nodes, CST " << countNodes(cstRoot)
+            << " nodes)\n";
+    printAST(ast, astFile);
 }
 
-void writeCSTToFile(CSTNode* node, std::ofstream& out, int depth = 0) {
-    if (!node) return;
+// strips comments and tokenizes the result, writing <file> and tokens_<file> to
+// outputDirectory if options.emit asks for them. the stripped source stays in memory, so
+// nothing touches the disk that is not emitted. false if the file cannot go on to the
+// parser (always after --stop-after=strip); the reasons are left in errors.
+// touches nothing but its own files, so several inputs can go through it at once.
+// with a timing (--time-report) the phases are timed into it
+bool stripAndTokenize(const fs::path& input, const std::string& outputDirectory, const RunOptions& options,
+                      ErrorHandler& errors, std::vector<Token>& tokens, FileTiming* timing = nullptr) {
+    std::string inputFilePath = input.string();
+    std::string outputFilePath = outputDirectory + "/" + input.filename().string();
+    std::string tokenOutputFile = outputDirectory + "/tokens_" + input.filename().string();
 
-    for (int i = 0; i < depth * 4; ++i) out << " ";
+    if (timing) {
+        std::error_code status;
+        uintmax_t size = fs::file_size(input, status);
+        timing->bytes = status ? 0 : size;
+    }
+    std::ostringstream stripped;
+    {
+        PhaseTimer timer(timing, PHASE_STRIP);
+        std::ifstream inputFile(inputFilePath);
+        if (!inputFile) {
+            errors.report(DIAG_CANNOT_OPEN_INPUT, 0, inputFilePath);
+            return false;
+        }
+        CommentRemover remover(errors);
+        if (!remover.removeComments(inputFile, stripped)) {
+            //std::cerr << "Skipping " << inputFilePath << " due to errors.\n\n";
+            return false;
+        }
+    }
 
-    if (node->name == "Symbol") {
-        out << '"' << node->value << '"' << std::endl;
-    } else {
-        out << node->name << " (" << node->value << ") [Line: " << node->lineNumber << "]" << std::endl;
+    auto writeStripped = [&] {
+        if (!(options.emit & EMIT_STRIPPED)) return;
+        PhaseTimer timer(timing, PHASE_WRITE);
+        TRACE_SCOPE("write stripped source");
+        std::ofstream strippedFile(outputFilePath);
+        if (!strippedFile) {
+            errors.report(DIAG_CANNOT_CREATE_OUTPUT, 0, outputFilePath);
+            return;
+        }
+        strippedFile << stripped.str();
+    };
+    if (options.stopAfter == STAGE_STRIP) {
+        writeStripped();
+        return false;
     }
 
-    if (node->leftChild) writeCSTToFile(node->leftChild, out, depth + 1);
-    if (node->rightSibling) writeCSTToFile(node->rightSibling, out, depth);
-}
+    {
+        PhaseTimer timer(timing, PHASE_LEX);
+        int finalLineNumber = 1;
+        std::istringstream strippedInput(stripped.str());
+        Tokenizer tokenizer(strippedInput, finalLineNumber, errors);
+        tokenizer.tokenize();
+        tokens = tokenizer.getTokens();
+    }
 
-int main() {
+    if (errors.hasErrors()) {
+        //std::cerr << "Skipping " << inputFilePath << " due to errors.\n\n";
+        return false;
+    }
+    writeStripped();
     
-    std::string testDirectory = "testfiles/TestFiles4";
-    std::string outputDirectory = "outputfiles";
+    // now we proceed to create the token output file only if no errors were detected
+    if (timing) timing->tokens = tokens.size();
 
-    if (!fs::exists(testDirectory) || !fs::is_directory(testDirectory)) {
-        std::cerr << "Test directory not found: " << testDirectory << std::endl;
-        return 1;
+    if (tokens.empty()) { 
+        //std::cerr << "Skipping " << inputFilePath << " due to empty token list.\n\n";
+        errors.report(DIAG_EMPTY_TOKEN_LIST, 0);
+        return false;  // move to the next file without creating the token file
     }
+    
+    if (options.emit & EMIT_TOKENS) {
+        PhaseTimer timer(timing, PHASE_WRITE);
+        TRACE_SCOPE("write tokens");
+        std::ofstream tokenFile(tokenOutputFile);
+        if (!tokenFile) {
+            //std::cerr << "error: Unable to create token output file " << tokenOutputFile << std::endl;
+            return false;
+        }
+
+        tokenFile << "Token list:\n\n";
+        for (const auto& token : tokens) {
+            tokenFile << "Token type: " << tokenTypeToString(token.type) << "\n";
+            tokenFile << "Token: " << token.value << "\n\n";
+        }
 
-    if (!fs::exists(outputDirectory)) {
-        fs::create_directory(outputDirectory);
+        tokenFile.close();
+        //std::cout << "tokens saved to: " << tokenOutputFile << std::endl;
     }
+    return options.stopAfter != STAGE_LEX;
+}
 
-    CommentRemover remover;
+// logs one unit's errors to the terminal and the run's error log
+void reportErrors(const ErrorHandler& errors, const std::string& unit, ErrorLog& errorLog) {
+    errors.printErrors(errorLog.getTerminal());
+    errorLog.write(errors, unit);
+}
 
-    for (const auto& entry : fs::directory_iterator(testDirectory)) {
-        if (entry.is_regular_file()) {
-            std::string inputFilePath = entry.path().string();
-            std::string outputFilePath = outputDirectory + "/" + entry.path().filename().string();
-            std::string tokenOutputFile = outputDirectory + "/tokens_" + entry.path().filename().string();
+// diagnostics.json / diagnostics.bin: everything the run logged, for tooling
+void writeDiagnosticOutputs(const std::vector<DiagnosticFile>& files, const std::string& outputDirectory, bool json,
+                            bool binary) {
+    if (json) {
+        std::ofstream jsonFile(outputDirectory + "/diagnostics.json");
+        if (jsonFile) writeDiagnosticsJson(files, jsonFile);
+    }
+    if (binary) writeDiagnosticsBinary(files, outputDirectory + "/diagnostics.bin");
+}
 
-            //std::cout << "Processing: " << inputFilePath << " -> " << outputFilePath << std::endl;
+// --multi-file: every file in the directory is one part of a single program. files are
+// stripped and tokenized in parallel, each into its own ErrorHandler, then parsed in
+// parallel into one global index that is checked across files. errors are reported per
+// file in input order
+int processProgramFiles(const std::vector<fs::path>& inputs, const std::string& outputDirectory,
+                        const RunOptions& options, unsigned int threadCount, ErrorLog& errorLog) {
+    ErrorAggregator diagnostics(inputs.size());
+    std::vector<std::vector<Token>> tokens(inputs.size());
+    std::vector<char> tokenized(inputs.size(), 0);
+    {
+        ThreadPool pool(threadCount);
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            pool.submit([&, i] {
+                ErrorHandler errors;
+                tokenized[i] = stripAndTokenize(inputs[i], outputDirectory, options, errors, tokens[i]);
+                diagnostics.merge(i, errors);
+            });
+        }
+        pool.wait();
+    }
 
-            int finalLineNumber = 1;
-            remover.removeComments(inputFilePath, outputFilePath);
+    std::vector<ProgramFile> files;
+    std::vector<size_t> fileUnits;  // input index of each entry in files
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (!tokenized[i]) continue;
+        files.emplace_back();
+        files.back().name = inputs[i].filename().string();
+        files.back().tokens = std::move(tokens[i]);
+        fileUnits.push_back(i);
+    }
 
-            if (errorHandler.hasErrors()) {
-                errorHandler.printErrors();
-                errorHandler.writeErrorsToFile("errors.txt");
-                errorHandler.clearErrors();
-                //std::cerr << "Skipping " << inputFilePath << " due to errors.\n\n";
-                continue;
+    GlobalIndex index;
+    parseProgramFiles(files, index, threadCount);
+    checkProgramFiles(files, index);
+    for (size_t i = 0; i < files.size(); ++i) diagnostics.merge(fileUnits[i], files[i].errors);
+
+    size_t next = 0;
+    for (size_t unit = 0; unit < inputs.size(); ++unit) {
+        ProgramFile* file = next < files.size() && fileUnits[next] == unit ? &files[next++] : nullptr;
+        std::string name = inputs[unit].filename().string();
+        std::string cstOutputFile = outputDirectory + "/cst_" + name;
+        std::string symbolOutputFile = outputDirectory + "/symboltable_" + name;
+
+        if (diagnostics.hasErrors(unit)) {
+            errorLog.writeLine("File: " + name);  // lines are per file
+            reportErrors(diagnostics.getErrors(unit), name, errorLog);
+            std::remove((outputDirectory + "/" + name).c_str());
+            std::remove((outputDirectory + "/tokens_" + name).c_str());
+            std::remove(cstOutputFile.c_str());
+            std::remove(symbolOutputFile.c_str());
+            std::remove((outputDirectory + "/ast_" + name).c_str());
+            continue;
+        }
+        if (!file) continue;
+
+        if (options.writeAST) {
+            ASTProgram* ast = lowerCST(file->cst);
+            writeASTFile(file->cst, ast, name, outputDirectory + "/ast_" + name);
+            delete ast;
+        }
+
+        if (options.emit & EMIT_CST) {
+            std::ofstream cstFile(cstOutputFile);
+            if (cstFile) {
+                cstFile << "CST for file: " << name << "\n";
+                writeCSTToFile(file->cst, cstFile);
             }
+        }
+        if (options.emit & EMIT_SYMBOLS) {
+            std::ofstream symbolFile(symbolOutputFile);
+            if (symbolFile) file->symbolTable.printTable(symbolFile);
+        }
+    }
 
-            Tokenizer tokenizer(outputFilePath, outputFilePath, finalLineNumber);
-            tokenizer.tokenize();
-
-            if (errorHandler.hasErrors()) {
-                errorHandler.printErrors();
-                errorHandler.writeErrorsToFile("errors.txt");
-            
-                // remove the partially created file if it exists
-                std::remove(outputFilePath.c_str());   
-                std::remove(tokenOutputFile.c_str());
-            
-                //std::cerr << "Skipping " << inputFilePath << " due to errors.\n\n";
-            
-                errorHandler.clearErrors(); // Clear errors here so the next file starts clean
-                continue;
+    std::ofstream globalFile(outputDirectory + "/global_symbols");
+    if (globalFile) printGlobalIndex(files, index, globalFile);
+
+    freeProgramFiles(files);
+    return 0;
+}
+
+// the whole single-file pipeline for one input: strip, tokenize, parse (and resolve/check),
+// then write its outputs. everything it touches is its own, so files can run concurrently;
+// errors are left in errors and the caller reports them. with an incremental parser (--watch)
+// the file is parsed through it, so only the definitions that changed since its last update
+// are parsed again; the parser keeps the tree. with a timing (--time-report) every phase is
+// timed into it, and the CST is written after parsing so the two are timed apart
+void processFile(const fs::path& input, const std::string& outputDirectory, const RunOptions& options,
+                 ErrorHandler& errors, IncrementalParser* incremental = nullptr, FileTiming* timing = nullptr) {
+    TRACE_SCOPE("processFile");
+    std::string name = input.filename().string();
+    std::string inputFilePath = input.string();
+    std::string outputFilePath = outputDirectory + "/" + name;
+    std::string tokenOutputFile = outputDirectory + "/tokens_" + name;
+
+    //std::cout << "Processing: " << inputFilePath << " -> " << outputFilePath << std::endl;
+
+    std::vector<Token> tokens;
+    if (!stripAndTokenize(input, outputDirectory, options, errors, tokens, timing)) return;
+    
+    // initialize TokenStream and Parser
+    TokenStream tokenStream(tokens);
+    Parser parser(tokenStream, errors);
+
+    // the CST is written out while it is parsed instead of being kept in memory
+    bool emitCSTFiles = options.emit & EMIT_CST;
+    bool checkNames = options.resolveNames && options.stopAfter == STAGE_SYMBOLS;
+    std::string cstOutputFile = outputDirectory + "/cst_" + name;
+    std::ofstream cstFile;
+    if (emitCSTFiles) cstFile.open(cstOutputFile);
+    CSTTextWriter cstWriter(cstFile);
+    CSTBinaryWriter cstBinaryWriter;
+    std::string cstJsonOutputFile = cstOutputFile + ".json";
+    std::ofstream cstJsonFile;
+    if (emitCSTFiles && options.writeJsonCST) cstJsonFile.open(cstJsonOutputFile);
+    CSTJsonWriter cstJsonWriter(cstJsonFile);
+
+    CSTListenerGroup cstWriters;
+    if (cstFile.is_open()) {
+        cstFile << "CST for file: " << name << "\n";
+        cstWriters.add(&cstWriter);
+    }
+    if (emitCSTFiles && options.writeBinaryCST) cstWriters.add(&cstBinaryWriter);
+    if (cstJsonFile.is_open()) cstWriters.add(&cstJsonWriter);
+    // resolution and --ast need the whole tree, so the CST is written after them instead of
+    // streamed. an incremental or parallel parse only has the tree at the end as well
+    bool streamCST = !checkNames && !incremental && !timing && !options.writeAST && !options.parallelParse;
+    if (!cstWriters.empty() && streamCST) parser.setListener(&cstWriters);
+
+    CSTNode* cstRoot = nullptr;
+    {
+        PhaseTimer timer(timing, PHASE_PARSE);
+        if (incremental) {
+            cstRoot = incremental->update(tokens);
+            errors.appendErrors(incremental->getErrors());
+        } else if (options.parallelParse) {
+            cstRoot = parser.parseProgramParallel(options.parseThreadCount);
+        } else {
+            cstRoot = parser.parseProgram();
+        }
+    }
+    if (timing) timing->nodes = countNodes(cstRoot);
+    const SymbolTable& symbolTable = incremental ? incremental->getSymbolTable() : parser.getSymbolTable();
+    // the incremental parser owns its tree
+    auto releaseTree = [&] {
+        if (!incremental) deleteTree(cstRoot);
+    };
+
+    if (!streamCST) {
+        if (checkNames && !errors.hasErrors()) {
+            PhaseTimer timer(timing, PHASE_SYMBOLS);
+            NameResolver resolver(symbolTable, errors);
+            resolver.resolve(cstRoot);
+            if (options.typeCheck) {
+                TypeChecker checker(symbolTable, resolver, errors);
+                checker.check(cstRoot);
             }
-            
-            
-            // now we proceed to create the token output file only if no errors were detected
-            const auto& tokens = tokenizer.getTokens();
-
-            if (tokens.empty()) { 
-                //std::cerr << "Skipping " << inputFilePath << " due to empty token list.\n\n";
-                errorHandler.addError(0, "Syntax Error: Token list generation failed. See terminal or error log.");
-                errorHandler.writeErrorsToFile("errors.txt");
-                errorHandler.clearErrors();
-                continue;  // move to the next file without creating the token file
+        }
+        PhaseTimer timer(timing, PHASE_WRITE);
+        TRACE_SCOPE("write CST");
+        for (const CSTNode* node = cstRoot; node; node = node->rightSibling) emitCST(node, cstWriters);
+    }
+    {
+        PhaseTimer timer(timing, PHASE_WRITE);
+        cstFile.close();
+        if (cstJsonFile.is_open()) {
+            cstJsonWriter.finish();
+            cstJsonFile.close();
+        }
+    }
+
+    if (errors.hasErrors()) {
+        std::remove(outputFilePath.c_str());
+        std::remove(tokenOutputFile.c_str());
+    
+        std::string symbolOutputFile = outputDirectory + "/symboltable_"  + name; 
+        std::remove(cstOutputFile.c_str());
+        std::remove(cstJsonOutputFile.c_str());
+        std::remove(symbolOutputFile.c_str());             
+        std::remove((outputDirectory + "/ast_" + name).c_str());
+
+        releaseTree();  // just in case
+        return;  // skip rest of file
+    }
+    
+    if (emitCSTFiles && options.writeBinaryCST) {
+        PhaseTimer timer(timing, PHASE_WRITE);
+        cstBinaryWriter.writeTo(cstOutputFile + ".bin");
+    }
+    if (options.writeAST) {
+        ASTProgram* ast = nullptr;
+        {
+            PhaseTimer timer(timing, PHASE_PARSE);
+            ast = lowerCST(cstRoot);
+        }
+        PhaseTimer timer(timing, PHASE_WRITE);
+        writeASTFile(cstRoot, ast, name, outputDirectory + "/ast_" + name);
+        delete ast;
+    }
+    if (options.stopAfter == STAGE_PARSE) {
+        releaseTree();
+        return;
+    }
+
+    std::string symbolOutputFile = outputDirectory + "/symboltable_" + name;
+    if (options.emit & EMIT_SYMBOLS) {
+        PhaseTimer timer(timing, PHASE_WRITE);
+        std::ofstream symbolFile(symbolOutputFile);
+        if (symbolFile) {
+            symbolTable.printTable(symbolFile);
+            symbolFile.close();
+        }
+        if (options.writeBinarySymbols) {
+            writeSymbolTableBinary(symbolTable, symbolOutputFile + ".bin");
+        }
+    }
+
+    if (options.writeFrames) {
+        std::vector<FrameLayout> layouts;
+        {
+            PhaseTimer timer(timing, PHASE_SYMBOLS);
+            layouts = computeFrameLayouts(symbolTable);
+        }
+        PhaseTimer timer(timing, PHASE_WRITE);
+        std::ofstream frameFile(outputDirectory + "/frames_" + name);
+        if (frameFile) printFrameLayouts(layouts, frameFile);
+    }
+
+    releaseTree();
+}
+
+// the files processFile can write for one input under options
+std::vector<std::string> outputNames(const std::string& name, const RunOptions& options) {
+    std::vector<std::string> names;
+    if (options.emit & EMIT_STRIPPED) names.push_back(name);
+    if (options.stopAfter >= STAGE_LEX && (options.emit & EMIT_TOKENS)) names.push_back("tokens_" + name);
+    if (options.stopAfter >= STAGE_PARSE && (options.emit & EMIT_CST)) {
+        names.push_back("cst_" + name);
+        if (options.writeBinaryCST) names.push_back("cst_" + name + ".bin");
+        if (options.writeJsonCST) names.push_back("cst_" + name + ".json");
+    }
+    if (options.stopAfter >= STAGE_PARSE && options.writeAST) names.push_back("ast_" + name);
+    if (options.stopAfter == STAGE_SYMBOLS) {
+        if (options.emit & EMIT_SYMBOLS) {
+            names.push_back("symboltable_" + name);
+            if (options.writeBinarySymbols) names.push_back("symboltable_" + name + ".bin");
+        }
+        if (options.writeFrames) names.push_back("frames_" + name);
+    }
+    return names;
+}
+
+// processFile through the build cache: an input that has not changed since a run with the
+// same options gets its outputs and errors back from the cache instead of being processed.
+// on a miss the input's old outputs are removed first, so the entry stored afterwards holds
+// exactly what this run wrote
+void processFileCached(const fs::path& input, const std::string& outputDirectory, const RunOptions& options,
+                       const BuildCache& cache, ErrorHandler& errors) {
+    std::string name = input.filename().string();
+    uint64_t key = 0;
+    uint64_t sourceSize = 0;
+    if (!cache.computeKey(input.string(), name, options, key, sourceSize)) {
+        processFile(input, outputDirectory, options, errors);  // reports the unreadable input
+        return;
+    }
+
+    std::vector<std::string> names = outputNames(name, options);
+    for (const std::string& output : names) std::remove((outputDirectory + "/" + output).c_str());
+
+    CacheEntry entry;
+    if (cache.load(key, name, sourceSize, entry)) {
+        for (const CachedOutput& output : entry.outputs) {
+            std::string path = outputDirectory + "/" + output.name;
+            if (!writeWholeFile(path, output.bytes)) errors.report(DIAG_CANNOT_CREATE_OUTPUT, 0, path);
+        }
+        for (const Diagnostic& diagnostic : entry.diagnostics) errors.add(diagnostic);
+        return;
+    }
+
+    processFile(input, outputDirectory, options, errors);
+
+    // file system errors say something about this machine, not the input, so they are not kept
+    for (const Diagnostic& diagnostic : errors.getDiagnostics()) {
+        if (diagnostic.code == DIAG_CANNOT_OPEN_INPUT || diagnostic.code == DIAG_CANNOT_CREATE_OUTPUT ||
+            diagnostic.code == DIAG_CANNOT_OPEN_FILE) {
+            return;
+        }
+    }
+    for (const std::string& output : names) {
+        MappedFile written;
+        if (!written.open(outputDirectory + "/" + output)) continue;
+        const char* bytes = reinterpret_cast<const char*>(written.data());
+        entry.outputs.push_back({output, std::vector<char>(bytes, bytes + written.size())});
+    }
+    entry.diagnostics = errors.getDiagnostics();
+    cache.store(key, name, sourceSize, entry);
+}
+
+// the number of workers processFiles starts for units files (threadCount 0 = one per core)
+unsigned int workerCount(unsigned int threadCount, size_t units) {
+    if (threadCount == 0) threadCount = ThreadPool::defaultThreadCount();
+    return static_cast<unsigned int>(std::min<size_t>(threadCount, std::max<size_t>(units, 1)));
+}
+
+// what processFiles runs for one input (its index in inputs), leaving the file's errors in errors
+using FileStep = std::function<void(size_t unit, ErrorHandler& errors)>;
+
+// runs step over inputs on threadCount workers (0 = one per core). every worker takes the
+// next file from a shared cursor over the inputs sorted by size, largest first, so the long
+// files start early and nobody idles while work is left. errors are reported in input order
+// once all files are done, so the log does not depend on the thread count. returns the
+// number of files with errors
+size_t processFiles(const std::vector<fs::path>& inputs, unsigned int threadCount, ErrorLog& errorLog,
+                    const FileStep& step) {
+    std::vector<std::pair<uintmax_t, size_t>> schedule;  // (size, input index)
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        std::error_code error;
+        uintmax_t size = fs::file_size(inputs[i], error);
+        schedule.push_back({error ? 0 : size, i});
+    }
+    std::sort(schedule.begin(), schedule.end(), [](const auto& a, const auto& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+
+    threadCount = workerCount(threadCount, inputs.size());
+
+    ErrorAggregator diagnostics(inputs.size());
+    std::atomic<size_t> next(0);
+    auto work = [&] {
+        for (size_t i = next++; i < schedule.size(); i = next++) {
+            size_t unit = schedule[i].second;
+            ErrorHandler errors;  // each file is its own compilation unit
+            step(unit, errors);
+            diagnostics.merge(unit, errors);
+        }
+    };
+    if (threadCount == 1) {
+        work();  // one file (or --jobs=1): no pool to start, e.g. for a compile server request
+    } else {
+        ThreadPool pool(threadCount);
+        for (unsigned int worker = 0; worker < threadCount; ++worker) pool.submit(work);
+        pool.wait();
+    }
+
+    size_t failed = 0;
+    for (size_t unit = 0; unit < inputs.size(); ++unit) {
+        if (!diagnostics.hasErrors(unit)) continue;
+        reportErrors(diagnostics.getErrors(unit), inputs[unit].filename().string(), errorLog);
+        failed++;
+    }
+    return failed;
+}
+
+// the directories --watch listens to: each directory input itself, otherwise the directory
+// a file or glob lives in
+std::set<std::string> watchedDirectories(const std::vector<std::string>& arguments) {
+    std::set<std::string> directories;
+    for (const std::string& argument : arguments) {
+        fs::path path(argument);
+        bool isGlob = path.filename().string().find_first_of("*?") != std::string::npos;
+        if (!isGlob && fs::is_directory(path)) directories.insert(path.string());
+        else directories.insert(path.has_parent_path() ? path.parent_path().string() : ".");
+    }
+    return directories;
+}
+
+// what --watch keeps in memory for one input between runs
+struct WatchedFile {
+    uint64_t hash = 0;                     // of the content last processed
+    IncrementalParser parser;              // its CST segments, reused on the next save
+    std::vector<Diagnostic> diagnostics;   // of the last run, for diagnostics.json/.bin
+};
+
+// --watch: runs every input once, then waits for saves and runs only the files that were
+// written, moved in or deleted since. each file keeps an IncrementalParser, so a save only
+// reparses the definitions it touched, and a save that leaves the content as it was is
+// skipped. errors.txt is flushed after every run. returns only if watching fails
+int watchInputs(const CommandLine& commandLine, std::vector<fs::path> inputs, ErrorLog& errorLog) {
+    const int DEBOUNCE_MILLISECONDS = 5;  // an editor's write + rename lands well within this
+
+    FileWatcher watcher;
+    if (!watcher.open()) {
+        std::cerr << "--watch needs inotify (Linux)" << std::endl;
+        return 1;
+    }
+    for (const std::string& directory : watchedDirectories(commandLine.inputs)) {
+        if (!watcher.watchDirectory(directory)) {
+            std::cerr << "Cannot watch directory: " << directory << std::endl;
+            return 1;
+        }
+    }
+
+    const std::string& outputDirectory = commandLine.outputDirectory;
+    const RunOptions& options = commandLine.options;
+    std::map<fs::path, std::unique_ptr<WatchedFile>> watched;
+
+    auto run = [&](const std::vector<fs::path>& candidates) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<fs::path> batch;
+        std::vector<WatchedFile*> states;
+        for (const fs::path& input : candidates) {
+            std::unique_ptr<WatchedFile>& state = watched[input];
+            if (!state) state.reset(new WatchedFile());
+            MappedFile content;
+            if (content.open(input.string())) {
+                uint64_t hash = contentHash(content.data(), content.size());
+                if (hash == state->hash && state->hash != 0) continue;  // saved without a change
+                state->hash = hash;
             }
-            
-            if (!errorHandler.hasErrors()) {  // Only create a token file if there are no errors
-                std::ofstream tokenFile(tokenOutputFile);
-                if (!tokenFile) {
-                    //std::cerr << "error: Unable to create token output file " << tokenOutputFile << std::endl;
-                    continue;
-                }
-            
-                tokenFile << "Token list:\n\n";
-                for (const auto& token : tokens) {
-                    tokenFile << "Token type: " << tokenTypeToString(token.type) << "\n";
-                    tokenFile << "Token: " << token.value << "\n\n";
+            batch.push_back(input);
+            states.push_back(state.get());
+        }
+        if (batch.empty()) return;
+
+        size_t failed = processFiles(batch, commandLine.threadCount, errorLog, [&](size_t unit, ErrorHandler& errors) {
+            processFile(batch[unit], outputDirectory, options, errors, &states[unit]->parser);
+            states[unit]->diagnostics = errors.getDiagnostics();
+        });
+        errorLog.flush();
+
+        if (commandLine.writeJsonDiagnostics || commandLine.writeBinaryDiagnostics) {
+            std::vector<DiagnosticFile> files;
+            for (const auto& entry : watched) {
+                if (!entry.second->diagnostics.empty()) {
+                    files.push_back({entry.first.filename().string(), entry.second->diagnostics});
                 }
-            
-                tokenFile.close();
-                //std::cout << "tokens saved to: " << tokenOutputFile << std::endl;
             }
-            
-            errorHandler.clearErrors();
-            
-            // initialize TokenStream and Parser
-            TokenStream tokenStream(tokens);
-            Parser parser(tokenStream, errorHandler);
-
-            CSTNode* cstRoot = parser.parseProgram();
-
-            if (errorHandler.hasErrors()) {
-                errorHandler.writeErrorsToFile("errors.txt");
-                errorHandler.printErrors();
-                std::remove(outputFilePath.c_str());
-                std::remove(tokenOutputFile.c_str());
-            
-                std::string cstOutputFile = outputDirectory + "/cst_" + entry.path().filename().string();
-                std::string symbolOutputFile = outputDirectory + "/symboltable_"  + entry.path().filename().string(); 
-                std::remove(cstOutputFile.c_str());
-                std::remove(symbolOutputFile.c_str());             
-
-                delete cstRoot;  // just in case
-                errorHandler.clearErrors();
-                continue;  // skip rest of file
+            writeDiagnosticOutputs(files, outputDirectory, commandLine.writeJsonDiagnostics,
+                                   commandLine.writeBinaryDiagnostics);
+        }
+
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "watch: processed " << batch.size() << " file(s) in " << milliseconds << " ms, " << failed
+                  << " with errors" << std::endl;
+    };
+
+    run(inputs);
+    std::vector<std::string> changed;
+    while (watcher.waitForChanges(DEBOUNCE_MILLISECONDS, changed)) {
+        // files may have been added or removed under a directory or glob input; the outputs
+        // of a removed one go with it. each argument is expanded on its own: a deleted file
+        // argument matches nothing, which must not drop the inputs named after it
+        inputs.clear();
+        for (const std::string& argument : commandLine.inputs) {
+            std::string error;
+            expandInputs({argument}, inputs, error);
+        }
+        std::sort(inputs.begin(), inputs.end());
+        inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+
+        std::set<fs::path> current(inputs.begin(), inputs.end());
+        for (auto entry = watched.begin(); entry != watched.end(); ) {
+            std::error_code status;
+            if (current.count(entry->first) || fs::exists(entry->first, status)) {
+                ++entry;
+                continue;
+            }
+            for (const std::string& output : outputNames(entry->first.filename().string(), options)) {
+                std::remove((outputDirectory + "/" + output).c_str());
             }
-            
-            if (cstRoot) {
-                std::string cstOutputFile = outputDirectory + "/cst_" + entry.path().filename().string();
-                std::ofstream cstFile(cstOutputFile);
-                if (cstFile) {
-                    cstFile << "CST for file: " << entry.path().filename().string() << "\n";
-                    writeCSTToFile(cstRoot, cstFile);
-                    cstFile.close();
-                }
-                std::string symbolOutputFile = outputDirectory + "/symboltable_" + entry.path().filename().string();
-                std::ofstream symbolFile(symbolOutputFile);
-                if (symbolFile) {
-                    parser.getSymbolTable().printTable(symbolFile);
-                    symbolFile.close();
+            entry = watched.erase(entry);
+        }
+
+        std::set<fs::path> touched;
+        for (const std::string& path : changed) touched.insert(fs::path(path).lexically_normal());
+        std::vector<fs::path> candidates;
+        for (const fs::path& input : inputs) {
+            if (touched.count(input.lexically_normal())) candidates.push_back(input);
+        }
+        run(candidates);
+    }
+    std::cerr << "--watch stopped: cannot read file events" << std::endl;
+    return 1;
 }
 
-                delete cstRoot;
+// runs what commandLine asks for over inputs (expanded, with the output directory in place),
+// logging to errorLog; with a cache (not null) unchanged files are taken from it. returns the
+// exit status. --time-report times every file, so it leaves the cache out, and prints its
+// summary where errors go
+int runPipeline(const CommandLine& commandLine, const std::vector<fs::path>& inputs, const BuildCache* cache,
+                ErrorLog& errorLog) {
+    const std::string& outputDirectory = commandLine.outputDirectory;
+    RunOptions options = commandLine.options;
+    if (options.parallelParse && options.parseThreadCount == 0) {
+        // the file workers share the cores: one large file gets them all, many files get one each
+        unsigned int workers = workerCount(commandLine.threadCount, inputs.size());
+        options.parseThreadCount = std::max(1u, ThreadPool::defaultThreadCount() / workers);
+    }
+    bool writeJsonDiagnostics = commandLine.writeJsonDiagnostics;
+    bool writeBinaryDiagnostics = commandLine.writeBinaryDiagnostics;
+    if (writeJsonDiagnostics || writeBinaryDiagnostics) errorLog.keepDiagnostics();
+
+    std::unique_ptr<TimeReport> report;
+    if (commandLine.timeReport) {
+        report.reset(new TimeReport());
+        report->files.resize(inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i) report->files[i].name = inputs[i].filename().string();
+        report->threadCount = workerCount(commandLine.threadCount, inputs.size());
+        cache = nullptr;
+    }
+    auto start = std::chrono::steady_clock::now();
+    double cpuStart = processCpuSeconds();
+
+    int status = 0;
+    if (commandLine.multiFile) {
+        status = processProgramFiles(inputs, outputDirectory, options, commandLine.threadCount, errorLog);
+    } else {
+        processFiles(inputs, commandLine.threadCount, errorLog, [&](size_t unit, ErrorHandler& errors) {
+            FileTiming* timing = report ? &report->files[unit] : nullptr;
+            if (cache) processFileCached(inputs[unit], outputDirectory, options, *cache, errors);
+            else processFile(inputs[unit], outputDirectory, options, errors, nullptr, timing);
+        });
+    }
+    writeDiagnosticOutputs(errorLog.getKeptDiagnostics(), outputDirectory, writeJsonDiagnostics, writeBinaryDiagnostics);
+
+    if (report) {
+        report->wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report->cpuSeconds = processCpuSeconds() - cpuStart;
+        report->printSummary(errorLog.getTerminal());
+        std::string reportFile = commandLine.timeReportFile.empty() ? outputDirectory + "/time_report.json"
+                                                                    : commandLine.timeReportFile;
+        std::ofstream jsonFile(reportFile);
+        if (jsonFile) report->writeJson(jsonFile);
+        else errorLog.getTerminal() << "Cannot create time report: " << reportFile << std::endl;
+    }
+    return status;
+}
+
+// one compile server request: the client's command line, run as the tokenizer would run it in
+// the client's directory, with everything it would print or log returned as text. inline
+// sources are written to scratch, processed there, and their outputs returned instead
+void runRequest(const CompileRequest& request, const BuildCache& cache, const std::string& scratch,
+                CompileResponse& response) {
+    std::vector<std::string> arguments = request.arguments;
+    arguments.insert(arguments.begin(), "tokenizer");
+    std::vector<char*> argv;
+    for (std::string& argument : arguments) argv.push_back(&argument[0]);
+
+    CommandLine commandLine;
+    std::string error;
+    response.status = 1;
+    if (!parseCommandLine(static_cast<int>(argv.size()), argv.data(), commandLine, error)) {
+        response.terminal = error + "\n";
+        return;
+    }
+    if (commandLine.watch || commandLine.serve || commandLine.showHelp || !commandLine.cacheDirectory.empty()) {
+        response.terminal = "--watch, --serve, --cache and --help cannot be sent to the server\n";
+        return;
+    }
+
+    // the server's working directory is not the client's
+    fs::path workingDirectory(request.workingDirectory);
+    auto resolve = [&](const std::string& path) {
+        return fs::path(path).is_absolute() ? path : (workingDirectory / path).string();
+    };
+    commandLine.outputDirectory = resolve(commandLine.outputDirectory);
+    response.outputDirectory = commandLine.outputDirectory;
+    if (!commandLine.timeReportFile.empty()) commandLine.timeReportFile = resolve(commandLine.timeReportFile);
+
+    bool inlineSources = !request.sources.empty();
+    std::error_code status;
+    if (inlineSources) {
+        fs::create_directories(scratch + "/in", status);
+        for (const InlineSource& source : request.sources) {
+            if (source.name.empty() || source.name.find_first_of("/\\") != std::string::npos ||
+                !writeWholeFile(scratch + "/in/" + source.name, source.text)) {
+                response.terminal = "cannot take inline source \"" + source.name + "\"\n";
+                fs::remove_all(scratch, status);
+                return;
             }
-            
-            
-            
         }
-            
+        commandLine.inputs = {scratch + "/in"};
+        commandLine.outputDirectory = scratch + "/out";
+    } else {
+        for (std::string& input : commandLine.inputs) input = resolve(input);
     }
-    return 0;
+
+    std::vector<fs::path> inputs;
+    fs::create_directories(commandLine.outputDirectory, status);
+    if (!expandInputs(commandLine.inputs, inputs, error)) {
+        response.terminal = error + "\n";
+    } else if (!fs::is_directory(commandLine.outputDirectory)) {
+        response.terminal = "Cannot create output directory: " + commandLine.outputDirectory + "\n";
+    } else {
+        std::ostringstream log;
+        std::ostringstream terminal;
+        {
+            ErrorLog errorLog(log, terminal);
+            response.status = runPipeline(commandLine, inputs, &cache, errorLog);
+        }
+        response.log = log.str();
+        response.terminal = terminal.str();
+    }
+
+    if (inlineSources) {
+        std::vector<fs::path> written;
+        for (const auto& entry : fs::directory_iterator(scratch + "/out", status)) written.push_back(entry.path());
+        std::sort(written.begin(), written.end());
+        for (const fs::path& path : written) {
+            MappedFile output;
+            if (!output.open(path.string())) continue;
+            const char* bytes = reinterpret_cast<const char*>(output.data());
+            response.outputs.push_back({path.filename().string(), std::vector<char>(bytes, bytes + output.size())});
+        }
+        fs::remove_all(scratch, status);
+    }
+}
+
+// --serve: stays resident and runs requests from tokenizer-client, received over a Unix domain
+// socket, on threadCount workers at once. the process, its threads and the in-memory result
+// cache outlive every request, so a request for an unchanged file under the same options is
+// answered from memory. runs until killed
+int serveRequests(const CommandLine& commandLine) {
+#ifdef SIGPIPE
+    std::signal(SIGPIPE, SIG_IGN);  // a client that hangs up early must not end the server
+#endif
+    std::string socketPath = commandLine.socketPath.empty() ? defaultSocketPath() : commandLine.socketPath;
+    CompileServerSocket server;
+    std::string error;
+    if (!server.listen(socketPath, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    // inline sources of request n go to <socket>.work/n
+    std::string scratch = socketPath + ".work";
+    std::error_code status;
+    fs::remove_all(scratch, status);
+
+    BuildCache cache("");  // in memory, shared by all requests
+    ThreadPool pool(commandLine.threadCount);
+    std::atomic<unsigned long> sequence(0);
+    std::cout << "serving on " << socketPath << " with " << pool.size() << " worker(s)" << std::endl;
+
+    for (int failures = 0; failures < 100; ) {
+        int connection = server.accept();
+        if (connection < 0) {
+            failures++;
+            continue;
+        }
+        failures = 0;
+        pool.submit([&, connection] {
+            CompileRequest request;
+            CompileResponse response;
+            if (receiveRequest(connection, request)) {
+                runRequest(request, cache, scratch + "/" + std::to_string(sequence++), response);
+                sendResponse(connection, response);
+            }
+            closeConnection(connection);
+        });
+    }
+    std::cerr << "stopped serving: cannot accept connections on " << socketPath << std::endl;
+    return 1;
 }
 
+int main(int argc, char* argv[]) {
+    CommandLine commandLine;
+    std::string error;
+    if (!parseCommandLine(argc, argv, commandLine, error)) {
+        std::cerr << error << "\n";
+        printUsage(argv[0], std::cerr);
+        return 1;
+    }
+    if (commandLine.showHelp) {
+        printUsage(argv[0], std::cout);
+        return 0;
+    }
+    if (commandLine.serve) return serveRequests(commandLine);
+
+    std::vector<fs::path> inputs;
+    if (!expandInputs(commandLine.inputs, inputs, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    const std::string& outputDirectory = commandLine.outputDirectory;
+    std::error_code created;
+    fs::create_directories(outputDirectory, created);
+    if (!fs::is_directory(outputDirectory)) {
+        std::cerr << "Cannot create output directory: " << outputDirectory << std::endl;
+        return 1;
+    }
+
+    BuildCache cache(commandLine.cacheDirectory);
+    bool useCache = !commandLine.cacheDirectory.empty();
+    if (useCache && !cache.open()) {
+        std::cerr << "Cannot create cache directory: " << commandLine.cacheDirectory << std::endl;
+        return 1;
+    }
+
+    ErrorLog errorLog("errors.txt");  // flushed when main returns
+    if (commandLine.watch) return watchInputs(commandLine, inputs, errorLog);
+    return runPipeline(commandLine, inputs, useCache ? &cache : nullptr, errorLog);
+}